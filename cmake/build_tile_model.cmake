@@ -0,0 +1,157 @@
+# build_tile_model.cmake
+#
+# Builds a small tesseract model which only knows the uppercase letters on the
+# tiles, by fine-tuning the stock English LSTM on captured tile images. The
+# output layer is replaced by one over A-Z, no dictionary is included and the
+# result is converted to an integer model, so it loads and runs faster than the
+# general purpose model.
+#
+# Run with cmake -P, normally through the tile_model target:
+#   cmake -DTILE_IMAGES_DIR=<dir> -DLANGDATA_DIR=<dir> -DOUTPUT_DIR=<dir> -DSTART_TRAINEDDATA=<file> -P build_tile_model.cmake
+#
+# TILE_IMAGES_DIR    Upright tile images <LETTER>_<anything>.png, e.g. A_0001.png.
+# LANGDATA_DIR       Directory containing radical-stroke.txt from tesseract's langdata_lstm.
+# OUTPUT_DIR         Working directory; the model is written to OUTPUT_DIR/<MODEL_NAME>.traineddata.
+# START_TRAINEDDATA  Float model to fine-tune, eng.traineddata from tessdata_best. The integer
+#                    model in resources/ cannot be trained.
+# MODEL_NAME         Name of the model, default tiles.
+# MAX_ITERATIONS     Training iterations, default 3000.
+#
+# Every tenth image is held out for evaluation and listed in OUTPUT_DIR/list.eval, which
+# the OCR benchmark accepts in place of a directory of images. The tesseract, combine_tessdata,
+# unicharset_extractor, combine_lang_model and lstmtraining tools must be on the PATH.
+
+cmake_minimum_required(VERSION 3.20)
+
+foreach(variable TILE_IMAGES_DIR LANGDATA_DIR OUTPUT_DIR START_TRAINEDDATA)
+    if(NOT ${variable})
+        message(FATAL_ERROR "${variable} must be set.")
+    endif()
+endforeach()
+if(NOT EXISTS "${START_TRAINEDDATA}")
+    message(FATAL_ERROR "Cannot find the start model ${START_TRAINEDDATA}, download eng.traineddata from tessdata_best.")
+endif()
+if(NOT MODEL_NAME)
+    set(MODEL_NAME "tiles")
+endif()
+if(NOT MAX_ITERATIONS)
+    set(MAX_ITERATIONS 3000)
+endif()
+
+foreach(tool tesseract combine_tessdata unicharset_extractor combine_lang_model lstmtraining)
+    find_program(${tool}_EXECUTABLE ${tool})
+    if(NOT ${tool}_EXECUTABLE)
+        message(FATAL_ERROR "Cannot find ${tool}, install the tesseract training tools.")
+    endif()
+endforeach()
+
+# Runs a command, stopping the build if it fails
+function(run_step description)
+    message(STATUS "${description}")
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result OUTPUT_QUIET)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${description} failed: ${result}")
+    endif()
+endfunction()
+
+# Reads the width and height from the header of a PNG file
+function(png_size path widthVariable heightVariable)
+    file(READ "${path}" header LIMIT 24 HEX)
+    string(SUBSTRING "${header}" 0 16 signature)
+    if(NOT signature STREQUAL "89504e470d0a1a0a")
+        message(FATAL_ERROR "${path} is not a PNG file.")
+    endif()
+    string(SUBSTRING "${header}" 32 8 width)
+    string(SUBSTRING "${header}" 40 8 height)
+    math(EXPR width "0x${width}")
+    math(EXPR height "0x${height}")
+    set(${widthVariable} ${width} PARENT_SCOPE)
+    set(${heightVariable} ${height} PARENT_SCOPE)
+endfunction()
+
+set(groundTruthDir "${OUTPUT_DIR}/ground-truth")
+set(tessdataDir "${OUTPUT_DIR}/tessdata")
+file(REMOVE_RECURSE "${groundTruthDir}")
+file(MAKE_DIRECTORY "${groundTruthDir}" "${tessdataDir}/configs")
+
+# The start model, and the config which makes tesseract write training data
+configure_file("${START_TRAINEDDATA}" "${tessdataDir}/eng.traineddata" COPYONLY)
+file(WRITE "${tessdataDir}/configs/lstm.train"
+    "file_type .bl\n"
+    "textord_fast_pitch_test T\n"
+    "tessedit_zero_rejection T\n"
+    "tessedit_minimal_rejection F\n"
+    "tessedit_write_rep_codes F\n"
+    "edges_children_fix F\n"
+    "edges_childarea 0.65\n"
+    "edges_boxarea 0.9\n"
+    "tessedit_train_line_recognizer T\n"
+    "textord_no_rejects T\n"
+    "tessedit_init_config_only T\n")
+
+# Ground truth: one line of one letter per tile image, boxed over the whole image
+file(GLOB tileImages "${TILE_IMAGES_DIR}/*.png")
+set(boxFiles "")
+set(trainList "")
+set(evalList "")
+set(sampleCount 0)
+foreach(tileImage IN LISTS tileImages)
+    get_filename_component(name "${tileImage}" NAME_WE)
+    string(REGEX MATCH "^[A-Z]_" prefix "${name}")
+    if(NOT prefix)
+        message(WARNING "Skipping ${tileImage}, its name does not start with its letter.")
+        continue()
+    endif()
+    string(SUBSTRING "${name}" 0 1 letter)
+    png_size("${tileImage}" width height)
+    math(EXPR right "${width} + 1")
+    math(EXPR bottom "${height} + 1")
+
+    set(base "${groundTruthDir}/${name}")
+    configure_file("${tileImage}" "${base}.png" COPYONLY)
+    file(WRITE "${base}.gt.txt" "${letter}\n")
+    file(WRITE "${base}.box" "${letter} 0 0 ${width} ${height} 0\n\t ${width} ${height} ${right} ${bottom} 0\n")
+    run_step("Writing training data for ${name}"
+        "${tesseract_EXECUTABLE}" "${base}.png" "${base}" --tessdata-dir "${tessdataDir}" --psm 13 lstm.train)
+    list(APPEND boxFiles "${base}.box")
+
+    math(EXPR held "${sampleCount} % 10")
+    if(held EQUAL 9)
+        string(APPEND evalList "${base}.lstmf\n")
+    else()
+        string(APPEND trainList "${base}.lstmf\n")
+    endif()
+    math(EXPR sampleCount "${sampleCount} + 1")
+endforeach()
+if(sampleCount LESS 10)
+    message(FATAL_ERROR "Found ${sampleCount} labelled tile images in ${TILE_IMAGES_DIR}, at least 10 are needed.")
+endif()
+file(WRITE "${OUTPUT_DIR}/list.train" "${trainList}")
+file(WRITE "${OUTPUT_DIR}/list.eval" "${evalList}")
+
+# Starter model over the letters only, without a dictionary
+run_step("Extracting the start model"
+    "${combine_tessdata_EXECUTABLE}" -e "${tessdataDir}/eng.traineddata" "${OUTPUT_DIR}/eng.lstm")
+run_step("Extracting the tile unicharset"
+    "${unicharset_extractor_EXECUTABLE}" --output_unicharset "${OUTPUT_DIR}/${MODEL_NAME}.unicharset" --norm_mode 1 ${boxFiles})
+run_step("Creating the starter model"
+    "${combine_lang_model_EXECUTABLE}" --input_unicharset "${OUTPUT_DIR}/${MODEL_NAME}.unicharset"
+    --script_dir "${LANGDATA_DIR}" --output_dir "${OUTPUT_DIR}" --lang "${MODEL_NAME}")
+
+# Fine-tune, remapping the output layer of the start model to the new unicharset
+file(MAKE_DIRECTORY "${OUTPUT_DIR}/checkpoints")
+run_step("Training for ${MAX_ITERATIONS} iterations on ${sampleCount} tiles"
+    "${lstmtraining_EXECUTABLE}"
+    --continue_from "${OUTPUT_DIR}/eng.lstm"
+    --old_traineddata "${tessdataDir}/eng.traineddata"
+    --traineddata "${OUTPUT_DIR}/${MODEL_NAME}/${MODEL_NAME}.traineddata"
+    --model_output "${OUTPUT_DIR}/checkpoints/${MODEL_NAME}"
+    --train_listfile "${OUTPUT_DIR}/list.train"
+    --eval_listfile "${OUTPUT_DIR}/list.eval"
+    --max_iterations ${MAX_ITERATIONS})
+run_step("Writing the integer model"
+    "${lstmtraining_EXECUTABLE}" --stop_training --convert_to_int
+    --continue_from "${OUTPUT_DIR}/checkpoints/${MODEL_NAME}_checkpoint"
+    --traineddata "${OUTPUT_DIR}/${MODEL_NAME}/${MODEL_NAME}.traineddata"
+    --model_output "${OUTPUT_DIR}/${MODEL_NAME}.traineddata")
+message(STATUS "Wrote ${OUTPUT_DIR}/${MODEL_NAME}.traineddata")
@@ -0,0 +1,364 @@
+/**
+ * @file anagram_index.h
+ * @brief Header file for the AnagramIndex class.
+ *
+ * Contains the declaration of the AnagramIndex class, which groups the
+ * words of a dictionary into anagram classes keyed by their sorted letters
+ * and keeps a letter count vector for every class. The counts are also
+ * stored column-wise so that every class can be tested against a letter
+ * multiset in a handful of vectorised passes. Several word lists can be
+ * merged into one index, with every word recording which lists contain it.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef ANAGRAM_INDEX_H
+#define ANAGRAM_INDEX_H
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <vector>
+#include <memory_resource>
+#include <istream>
+#include <algorithm>
+#include <unordered_map>
+#include <limits>
+#include <stdexcept>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ANAGRAM_INDEX_SSE2
+#endif
+
+/**
+ * @brief Number of occurrences of each letter A-Z in a word.
+ */
+using LetterCounts = std::array<std::uint8_t, 26>;
+
+/**
+ * @brief Bit i is set when a word belongs to the ith word list of an index.
+ */
+using LexiconMask = std::uint8_t;
+
+/**
+ * @struct StringHash
+ * @brief Hash for string keyed maps which can also be searched by string_view without copying.
+ */
+struct StringHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view s) const {
+        return std::hash<std::string_view>()(s);
+    }
+};
+
+/**
+ * @struct AnagramClass
+ * @brief All dictionary words which are anagrams of each other.
+ *
+ * lexicons[i] holds the word lists containing anagrams[i] and lexiconMask
+ * is the union over the whole class.
+ */
+struct AnagramClass {
+    std::string sortedWord;
+    LetterCounts counts;
+    std::vector<std::string> anagrams;
+    std::vector<LexiconMask> lexicons;
+    LexiconMask lexiconMask;
+};
+
+/**
+ * @class AnagramIndex
+ * @brief Dictionary of words grouped into anagram classes.
+ *
+ * Words are stored in uppercase and only words of at least three letters
+ * are kept, since shorter words can never be snatched. Classes are sorted
+ * by length and the index is immutable once constructed.
+ */
+class AnagramIndex {
+public:
+    static constexpr LexiconMask allLexicons{ std::numeric_limits<LexiconMask>::max() };
+
+    AnagramIndex() = default;
+
+    /**
+     * @brief Builds the index from a stream with one word per line.
+     *
+     * @param words Stream containing the dictionary words.
+     */
+    explicit AnagramIndex(std::istream& words) : AnagramIndex(std::vector<std::istream*>{ &words }) {}
+
+    /**
+     * @brief Builds a merged index from several word lists.
+     *
+     * Words from lexicons[i] are marked with bit i of their LexiconMask.
+     *
+     * @param lexicons Streams containing one word per line, at most eight.
+     * @throw std::invalid_argument If there are too many word lists.
+     */
+    explicit AnagramIndex(const std::vector<std::istream*>& lexicons) {
+        if (std::size(lexicons) > 8 * sizeof(LexiconMask)) {
+            throw std::invalid_argument("Too many word lists for one anagram index.");
+        }
+        for (std::size_t i = 0; i < std::size(lexicons); ++i) {
+            std::string word;
+            while (std::getline(*lexicons[i], word)) {
+                addWord(word, static_cast<LexiconMask>(1u << i));
+            }
+        }
+        buildColumns();
+    }
+
+    /**
+     * @brief Looks up the anagram class of a sorted string.
+     *
+     * @param sortedWord Uppercase letters in sorted order.
+     * @return Pointer to the class, or nullptr if there are no anagrams.
+     */
+    const AnagramClass* findClass(std::string_view sortedWord) const {
+        auto it = sortedWordToClass.find(sortedWord);
+        return it == sortedWordToClass.end() ? nullptr : &classes[it->second];
+    }
+
+    /**
+     * @return All anagram classes in the index.
+     */
+    const std::vector<AnagramClass>& getClasses() const {
+        return classes;
+    }
+
+    /**
+     * @brief Converts a word into the form stored in the index.
+     *
+     * @param word The word, converted to uppercase in place.
+     * @param sortedWord Set to the letters of the word in sorted order.
+     * @param counts Set to the letter counts of the word.
+     * @return false if the word is too short or contains a character outside A-Z.
+     */
+    static bool normalizeWord(std::string& word, std::string& sortedWord, LetterCounts& counts) {
+        // snatchable words must be at least length three
+        if (std::size(word) < 3) { return false; }
+        std::transform(word.begin(), word.end(), word.begin(), [](char c) { return std::toupper(c); });
+        counts = LetterCounts{};
+        if (!countLetters(word, counts)) { return false; }
+        sortedWord = word;
+        std::sort(sortedWord.begin(), sortedWord.end());
+        return true;
+    }
+
+    /**
+     * @brief Adds the letter counts of a word to an existing count vector.
+     *
+     * @param word Uppercase word.
+     * @param counts Count vector to accumulate into.
+     * @return false if the word contains a character outside A-Z.
+     */
+    static bool countLetters(std::string_view word, LetterCounts& counts) {
+        for (char c : word) {
+            if (c < 'A' || c > 'Z') { return false; }
+            ++counts[c - 'A'];
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks whether one letter multiset is contained in another.
+     *
+     * @param inner The candidate sub-multiset.
+     * @param outer The containing multiset.
+     * @return true if every letter count of inner is at most that of outer.
+     */
+    static bool fitsWithin(const LetterCounts& inner, const LetterCounts& outer) {
+        for (std::size_t i = 0; i < std::size(inner); ++i) {
+            if (inner[i] > outer[i]) { return false; }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Finds every anagram class whose letters fit within a multiset.
+     *
+     * Scans the column-wise letter counts of all classes which are no longer than
+     * the query, one letter at a time, skipping letters which no class needs more
+     * of than the query has.
+     *
+     * @param query The available letters.
+     * @param minLength Only classes with at least this many letters are returned.
+     * @param lexicons Only classes with a word in one of these word lists are returned.
+     * @return Indices into getClasses() of the fitting classes, shortest first.
+     */
+    std::vector<std::size_t> findFittingClasses(const LetterCounts& query, std::size_t minLength = 0, LexiconMask lexicons = allLexicons) const {
+        std::vector<std::size_t> fitting{};
+        collectFittingClasses(query, minLength, lexicons, fitting);
+        return fitting;
+    }
+
+    /**
+     * @brief Finds every anagram class whose letters fit within a multiset, allocating the result from a memory resource.
+     *
+     * @param query The available letters.
+     * @param minLength Only classes with at least this many letters are returned.
+     * @param lexicons Only classes with a word in one of these word lists are returned.
+     * @param resource Memory resource for the result, e.g. a FrameArena.
+     * @return Indices into getClasses() of the fitting classes, shortest first.
+     */
+    std::pmr::vector<std::size_t> findFittingClasses(const LetterCounts& query, std::size_t minLength, LexiconMask lexicons, std::pmr::memory_resource* resource) const {
+        std::pmr::vector<std::size_t> fitting{ resource };
+        collectFittingClasses(query, minLength, lexicons, fitting);
+        return fitting;
+    }
+
+private:
+    std::vector<AnagramClass> classes;
+    std::unordered_map<std::string, std::size_t, StringHash, std::equal_to<>> sortedWordToClass;
+    std::array<std::vector<std::uint8_t>, 26> letterColumns{}; // letterColumns[letter][class]
+    std::vector<LexiconMask> lexiconColumn{};
+    LetterCounts columnMaxima{};
+    std::vector<std::size_t> lengthOffsets{ 0 }; // index of the first class with at least i letters
+
+    /**
+     * @brief Adds a word to the index.
+     *
+     * @param word The word to add; it is converted to uppercase.
+     * @param lexicon The bit of the word list the word comes from.
+     */
+    void addWord(std::string word, LexiconMask lexicon) {
+        std::string sortedWord;
+        LetterCounts counts{};
+        if (!normalizeWord(word, sortedWord, counts)) { return; }
+
+        auto [it, inserted] = sortedWordToClass.try_emplace(sortedWord, std::size(classes));
+        if (inserted) {
+            classes.push_back(AnagramClass{ sortedWord, counts, {}, {}, 0 });
+        }
+        AnagramClass& anagramClass = classes[it->second];
+        anagramClass.lexiconMask |= lexicon;
+        // The same word usually appears in several word lists
+        auto existing = std::find(anagramClass.anagrams.begin(), anagramClass.anagrams.end(), word);
+        if (existing != anagramClass.anagrams.end()) {
+            anagramClass.lexicons[existing - anagramClass.anagrams.begin()] |= lexicon;
+        }
+        else {
+            anagramClass.anagrams.push_back(std::move(word));
+            anagramClass.lexicons.push_back(lexicon);
+        }
+    }
+
+    /**
+     * @brief Sorts the classes by length and lays out their letter counts column-wise.
+     */
+    void buildColumns() {
+        std::stable_sort(classes.begin(), classes.end(), [](const AnagramClass& a, const AnagramClass& b) {
+            return std::size(a.sortedWord) < std::size(b.sortedWord);
+        });
+        sortedWordToClass.clear();
+        lengthOffsets.assign(1, 0);
+        lexiconColumn.clear();
+        lexiconColumn.reserve(std::size(classes));
+        for (std::vector<std::uint8_t>& column : letterColumns) {
+            column.clear();
+            column.reserve(std::size(classes));
+        }
+        for (std::size_t i = 0; i < std::size(classes); ++i) {
+            const AnagramClass& anagramClass = classes[i];
+            sortedWordToClass.emplace(anagramClass.sortedWord, i);
+            lexiconColumn.push_back(anagramClass.lexiconMask);
+            while (std::size(lengthOffsets) <= std::size(anagramClass.sortedWord)) {
+                lengthOffsets.push_back(i);
+            }
+            for (std::size_t letter = 0; letter < 26; ++letter) {
+                letterColumns[letter].push_back(anagramClass.counts[letter]);
+                columnMaxima[letter] = std::max(columnMaxima[letter], anagramClass.counts[letter]);
+            }
+        }
+        lengthOffsets.push_back(std::size(classes));
+    }
+
+    /**
+     * @brief Appends the indices of the classes fitting within a multiset, see findFittingClasses.
+     *
+     * @param fitting An empty vector receiving the indices.
+     */
+    template <typename Indices>
+    void collectFittingClasses(const LetterCounts& query, std::size_t minLength, LexiconMask lexicons, Indices& fitting) const {
+        std::size_t queryLength{ 0 };
+        for (std::uint8_t count : query) { queryLength += count; }
+        const std::size_t begin{ lengthOffsets[std::min(minLength, std::size(lengthOffsets) - 1)] };
+        const std::size_t end{ lengthOffsets[std::min(queryLength + 1, std::size(lengthOffsets) - 1)] };
+        if (begin >= end) { return; }
+
+        // Letters the query lacks rule out the most classes, so scan those first
+        std::array<std::size_t, 26> letters{};
+        std::size_t numLetters{ 0 };
+        for (std::size_t letter = 0; letter < 26; ++letter) {
+            if (columnMaxima[letter] > query[letter]) { letters[numLetters++] = letter; }
+        }
+        std::stable_sort(letters.begin(), letters.begin() + numLetters, [&query](std::size_t a, std::size_t b) { return query[a] < query[b]; });
+
+        // Scan in cache sized blocks so a block can be abandoned once nothing in it fits
+        constexpr std::size_t blockSize{ 4096 };
+        std::array<std::uint8_t, blockSize> fits;
+        for (std::size_t blockBegin = begin; blockBegin < end; blockBegin += blockSize) {
+            const std::size_t n{ std::min(blockSize, end - blockBegin) };
+            bool anyFit{ false };
+            for (std::size_t i = 0; i < n; ++i) {
+                fits[i] = (lexiconColumn[blockBegin + i] & lexicons) ? 0xFF : 0x00;
+                anyFit |= fits[i] != 0;
+            }
+            for (std::size_t i = 0; i < numLetters && anyFit; ++i) {
+                anyFit = scanColumn(letterColumns[letters[i]].data() + blockBegin, query[letters[i]], fits.data(), n);
+            }
+            if (!anyFit) { continue; }
+            // Skip eight flags at a time when none are set, otherwise compact them branch-free
+            std::size_t numFitting{ std::size(fitting) };
+            fitting.resize(numFitting + n);
+            for (std::size_t i = 0; i < n; i += 8) {
+                std::uint64_t group{ 0 };
+                std::memcpy(&group, fits.data() + i, std::min<std::size_t>(8, n - i));
+                if (group == 0) { continue; }
+                for (std::size_t j = i; j < std::min(i + 8, n); ++j) {
+                    fitting[numFitting] = blockBegin + j;
+                    numFitting += fits[j] & 1;
+                }
+            }
+            fitting.resize(numFitting);
+        }
+    }
+
+    /**
+     * @brief Clears the flag of every class needing more of a letter than is available.
+     *
+     * @param column Count of the letter for each class.
+     * @param available Count of the letter in the query.
+     * @param fits Per-class flags, 0xFF while the class still fits.
+     * @param n Number of classes to scan.
+     * @return false if no flags remain set.
+     */
+    static bool scanColumn(const std::uint8_t* column, std::uint8_t available, std::uint8_t* fits, std::size_t n) {
+        std::size_t i{ 0 };
+        std::uint8_t anyFit{ 0 };
+#ifdef ANAGRAM_INDEX_SSE2
+        // column <= available exactly when max(column, available) == available
+        const __m128i availableVector = _mm_set1_epi8(static_cast<char>(available));
+        __m128i anyFitVector = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16) {
+            __m128i counts = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+            __m128i flags = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fits + i));
+            __m128i within = _mm_cmpeq_epi8(_mm_max_epu8(counts, availableVector), availableVector);
+            flags = _mm_and_si128(flags, within);
+            anyFitVector = _mm_or_si128(anyFitVector, flags);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(fits + i), flags);
+        }
+        anyFit = _mm_movemask_epi8(anyFitVector) != 0 ? 0xFF : 0x00;
+#endif
+        for (; i < n; ++i) {
+            fits[i] &= column[i] <= available ? 0xFF : 0x00;
+            anyFit |= fits[i];
+        }
+        return anyFit != 0;
+    }
+};
+
+#endif
@@ -0,0 +1,208 @@
+/**
+ * @file batch_files.h
+ * @brief Header file for the files of a batch run over recorded games.
+ *
+ * This file contains functions which split recorded games into chunks of
+ * frames, save the boards recognised in each chunk, and combine the chunks of
+ * a game into its result log. A chunk is saved to its own part file, so an
+ * interrupted batch run resumes from the chunks already done.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef BATCH_FILES_H
+#define BATCH_FILES_H
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <cctype>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+#include "session_analyzer.h"
+
+/**
+ * @struct ChunkJob
+ * @brief A run of frames from one recorded game, the unit of work of a batch run.
+ */
+struct ChunkJob {
+    std::filesystem::path video;
+    std::size_t chunk; // index of the chunk within the video
+    std::size_t numChunks; // chunks in the video
+    int startFrame;
+    int endFrame; // one past the last frame, or -1 for the end of the video
+};
+
+namespace BatchFiles {
+    /**
+     * @brief Extensions of the video files picked up from the input directory.
+     */
+    inline const std::vector<std::string> videoExtensions{ ".mp4", ".avi", ".mkv", ".mov", ".webm", ".m4v" };
+
+    /**
+     * @brief Lists the videos in a directory, in name order.
+     *
+     * @param directory Directory of recorded games.
+     * @return Paths of the files with a video extension.
+     * @throw std::runtime_error If the directory does not exist.
+     */
+    inline std::vector<std::filesystem::path> findVideos(const std::filesystem::path& directory) {
+        if (!std::filesystem::is_directory(directory)) {
+            throw std::runtime_error("Cannot open directory " + directory.string() + ".");
+        }
+        std::vector<std::filesystem::path> videos{};
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            std::string extension{ entry.path().extension().string() };
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (entry.is_regular_file() && std::find(videoExtensions.begin(), videoExtensions.end(), extension) != videoExtensions.end()) {
+                videos.push_back(entry.path());
+            }
+        }
+        std::sort(videos.begin(), videos.end());
+        return videos;
+    }
+
+    /**
+     * @brief Splits a video into chunks of consecutive frames.
+     *
+     * @param video Path of the video.
+     * @param frameCount Number of frames in the video, or 0 or less if it is unknown.
+     * @param framesPerChunk Number of frames in each chunk but the last.
+     * @return The chunks in order; a single chunk to the end of the video if the frame count is unknown.
+     */
+    inline std::vector<ChunkJob> planChunks(const std::filesystem::path& video, int frameCount, int framesPerChunk) {
+        if (frameCount <= 0 || framesPerChunk <= 0) return { ChunkJob{ video, 0, 1, 0, -1 } };
+        const std::size_t numChunks{ static_cast<std::size_t>((frameCount + framesPerChunk - 1) / framesPerChunk) };
+        std::vector<ChunkJob> chunks{};
+        for (std::size_t chunk = 0; chunk < numChunks; ++chunk) {
+            const int startFrame{ static_cast<int>(chunk) * framesPerChunk };
+            // The last chunk reads to the end, in case the frame count was an underestimate
+            const int endFrame{ chunk + 1 == numChunks ? -1 : startFrame + framesPerChunk };
+            chunks.push_back(ChunkJob{ video, chunk, numChunks, startFrame, endFrame });
+        }
+        return chunks;
+    }
+
+    /**
+     * @return Path of the result log of a video, named after the video's whole file name
+     *         so that e.g. game.mp4 and game.mkv do not share a log.
+     */
+    inline std::filesystem::path logPath(const std::filesystem::path& outputDirectory, const std::filesystem::path& video) {
+        return outputDirectory / (video.filename().string() + ".log");
+    }
+
+    /**
+     * @return Path of the part file holding the boards recognised in a chunk.
+     */
+    inline std::filesystem::path partPath(const std::filesystem::path& outputDirectory, const ChunkJob& job) {
+        return outputDirectory / (job.video.filename().string() + "." + std::to_string(job.chunk) + "-of-" + std::to_string(job.numChunks) + ".part");
+    }
+
+    /**
+     * @brief Writes a file so that it either exists complete or not at all.
+     *
+     * @param path Path of the file.
+     * @param contents The contents of the file.
+     * @throw std::runtime_error If the file cannot be written.
+     */
+    inline void writeFileAtomically(const std::filesystem::path& path, const std::string& contents) {
+        std::filesystem::path temporaryPath{ path };
+        temporaryPath += ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary);
+            file << contents;
+            if (!file) { throw std::runtime_error("Cannot write " + temporaryPath.string() + "."); }
+        }
+        std::filesystem::rename(temporaryPath, path);
+    }
+
+    /**
+     * @brief Serialises boards, one line per frame: the timestamp followed by the words, tab separated.
+     */
+    inline std::string formatObservations(const std::vector<BoardObservation>& observations) {
+        std::ostringstream os;
+        os << std::setprecision(17);
+        for (const BoardObservation& observation : observations) {
+            os << observation.timestamp;
+            for (const std::string& word : observation.words) os << '\t' << word;
+            os << '\n';
+        }
+        return os.str();
+    }
+
+    /**
+     * @brief Reads boards written by formatObservations.
+     */
+    inline std::vector<BoardObservation> parseObservations(std::istream& is) {
+        std::vector<BoardObservation> observations{};
+        std::string line;
+        while (std::getline(is, line)) {
+            if (line.empty()) continue;
+            std::istringstream fields(line);
+            std::string field;
+            std::getline(fields, field, '\t');
+            BoardObservation observation{ std::stod(field), {} };
+            while (std::getline(fields, field, '\t')) observation.words.push_back(field);
+            observations.push_back(std::move(observation));
+        }
+        return observations;
+    }
+
+    /**
+     * @brief Saves the boards recognised in a chunk.
+     */
+    inline void writeChunk(const std::filesystem::path& outputDirectory, const ChunkJob& job, const std::vector<BoardObservation>& observations) {
+        writeFileAtomically(partPath(outputDirectory, job), formatObservations(observations));
+    }
+
+    /**
+     * @return true if the chunk was saved by an earlier run, or its video's log has been written.
+     */
+    inline bool isDone(const std::filesystem::path& outputDirectory, const ChunkJob& job) {
+        return std::filesystem::exists(logPath(outputDirectory, job.video)) || std::filesystem::exists(partPath(outputDirectory, job));
+    }
+
+    /**
+     * @brief Combines the saved chunks of a video into its result log, once every chunk has been saved.
+     *
+     * The log lists each play that became available, with when it appeared and
+     * when it was claimed. The part files are removed once the log is written.
+     *
+     * @param outputDirectory Directory of the part files and logs.
+     * @param job Any chunk of the video.
+     * @return true if the log was written, false if some chunks are still missing.
+     * @throw std::runtime_error If a part file or the log cannot be read or written.
+     */
+    inline bool writeLogIfComplete(const std::filesystem::path& outputDirectory, const ChunkJob& job) {
+        std::vector<std::filesystem::path> parts{};
+        for (std::size_t chunk = 0; chunk < job.numChunks; ++chunk) {
+            ChunkJob part{ job };
+            part.chunk = chunk;
+            parts.push_back(partPath(outputDirectory, part));
+            if (!std::filesystem::exists(parts.back())) return false;
+        }
+
+        std::vector<BoardObservation> observations{};
+        for (const std::filesystem::path& part : parts) {
+            std::ifstream file(part);
+            if (!file) { throw std::runtime_error("Cannot read " + part.string() + "."); }
+            std::vector<BoardObservation> chunkObservations{ parseObservations(file) };
+            observations.insert(observations.end(), chunkObservations.begin(), chunkObservations.end());
+        }
+
+        // One solver thread, the other cores are busy recognising
+        std::vector<AvailabilityWindow> windows{ SessionAnalyzer::findAvailabilityWindows(observations, SnatchQuery{}, 1) };
+        std::ostringstream os;
+        os << "# " << job.video.string() << '\n' << "# " << std::size(observations) << " frames\n";
+        for (const AvailabilityWindow& window : windows) {
+            os << window.word << '\t' << window.start << '\t' << window.end << '\n';
+        }
+        writeFileAtomically(logPath(outputDirectory, job.video), os.str());
+        for (const std::filesystem::path& part : parts) std::filesystem::remove(part);
+        return true;
+    }
+}
+
+#endif
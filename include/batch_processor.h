@@ -0,0 +1,198 @@
+/**
+ * @file batch_processor.h
+ * @brief Header file for the BatchProcessor class.
+ *
+ * This file contains the declaration of the BatchProcessor class, which
+ * analyses a directory of recorded games offline on every core and writes a
+ * result log for each game.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef BATCH_PROCESSOR_H
+#define BATCH_PROCESSOR_H
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <opencv2/opencv.hpp>
+#include "batch_files.h"
+#include "text_detector.h"
+#include "text_recognizer.h"
+#include "tile_pitch_estimator.h"
+
+/**
+ * @class BatchProcessor
+ * @brief Recognises the boards in many recorded games across a pool of workers.
+ *
+ * Each game is split into chunks of frames and the chunks of all the games
+ * are shared out between the workers, so a few long games keep every core busy.
+ * Each worker has its own tesseract engine and tile size estimate. The boards
+ * of each chunk are saved to a part file as soon as it is done, and the worker
+ * which finishes the last chunk of a game writes the game's log while the
+ * others carry on. Chunks and games already saved by an interrupted run are skipped.
+ */
+class BatchProcessor {
+public:
+    /**
+     * @brief Sets up a batch run.
+     *
+     * @param outputDirectory Directory for the result logs and part files; it is created if needed.
+     * @param numWorkers Number of workers, or 0 for one per core.
+     * @param framesPerChunk Number of frames each worker takes at a time.
+     */
+    explicit BatchProcessor(const std::filesystem::path& outputDirectory, unsigned numWorkers = 0, int framesPerChunk = 600)
+        : outputDirectory(outputDirectory), numWorkers(numWorkers), framesPerChunk(framesPerChunk) {
+        if (this->numWorkers == 0) this->numWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @brief Sets how the workers separate tiles from the table.
+     */
+    void setDetectionMode(TextDetector::DetectionMode mode) {
+        detectionMode = mode;
+    }
+
+    /**
+     * @brief Sets the tesseract model the workers load instead of eng.
+     */
+    void setModel(const std::string& model) {
+        this->model = model;
+    }
+
+    /**
+     * @brief Sets how the workers recognise the letters of a word.
+     */
+    void setRecognitionMode(TextRecognizer::RecognitionMode mode) {
+        recognitionMode = mode;
+    }
+
+    /**
+     * @brief Analyses every recorded game in a directory.
+     *
+     * @param inputDirectory Directory of recorded games.
+     * @return Number of games whose logs could not be written, e.g. because the video could not be opened.
+     * @throw std::runtime_error If the input directory cannot be read or a worker cannot be initialized.
+     */
+    std::size_t run(const std::filesystem::path& inputDirectory) {
+        std::filesystem::create_directories(outputDirectory);
+        std::vector<ChunkJob> jobs{};
+        remainingChunks.clear();
+        for (const std::filesystem::path& video : BatchFiles::findVideos(inputDirectory)) {
+            if (std::filesystem::exists(BatchFiles::logPath(outputDirectory, video))) continue;
+            cv::VideoCapture capture(video.string());
+            const int frameCount{ static_cast<int>(capture.get(cv::CAP_PROP_FRAME_COUNT)) };
+            const std::vector<ChunkJob> chunks{ BatchFiles::planChunks(video, frameCount, framesPerChunk) };
+            const std::size_t numJobs{ std::size(jobs) };
+            for (const ChunkJob& job : chunks) {
+                if (!BatchFiles::isDone(outputDirectory, job)) jobs.push_back(job);
+            }
+            // A run interrupted after the last chunk but before the log only needs the log
+            if (std::size(jobs) == numJobs) BatchFiles::writeLogIfComplete(outputDirectory, chunks.front());
+            else remainingChunks.try_emplace(video, std::size(jobs) - numJobs);
+        }
+
+        nextJob = 0;
+        failedVideos.clear();
+        std::vector<std::thread> workers{};
+        std::vector<std::exception_ptr> errors(numWorkers);
+        for (unsigned i = 0; i < std::min<std::size_t>(numWorkers, std::size(jobs)); ++i) {
+            workers.emplace_back([this, &jobs, &errors, i]() {
+                try { work(jobs); }
+                catch (...) { errors[i] = std::current_exception(); }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+        for (const std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+        return std::size(failedVideos);
+    }
+
+private:
+    std::filesystem::path outputDirectory;
+    unsigned numWorkers;
+    int framesPerChunk;
+    TextDetector::DetectionMode detectionMode{ TextDetector::DetectionMode::Threshold };
+    TextRecognizer::RecognitionMode recognitionMode{ TextRecognizer::RecognitionMode::PerTile };
+    std::string model{};
+    std::atomic<std::size_t> nextJob{ 0 };
+    std::map<std::filesystem::path, std::atomic<std::size_t>> remainingChunks{}; // chunks of each game still to be done in this run
+    std::vector<std::filesystem::path> failedVideos{};
+    std::mutex mutex; // guards failedVideos and the console
+
+    /**
+     * @brief Worker: takes chunks until there are none left.
+     *
+     * @param jobs The chunks of this run.
+     */
+    void work(const std::vector<ChunkJob>& jobs) {
+        TilePitchEstimator tilePitchEstimator{};
+        std::unique_ptr<TextRecognizer> textRecognizer{ TextRecognizer::createInstance(tilePitchEstimator) };
+        textRecognizer->setRecognitionMode(recognitionMode);
+        if (!model.empty()) textRecognizer->loadModel(model);
+
+        for (std::size_t i = nextJob++; i < std::size(jobs); i = nextJob++) {
+            const ChunkJob& job{ jobs[i] };
+            std::vector<BoardObservation> observations{};
+            const bool recognized{ recognizeChunk(job, tilePitchEstimator, *textRecognizer, observations) };
+            if (recognized) {
+                BatchFiles::writeChunk(outputDirectory, job, observations);
+            }
+            else {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (std::find(failedVideos.begin(), failedVideos.end(), job.video) == failedVideos.end()) {
+                    failedVideos.push_back(job.video);
+                    std::cerr << "Cannot open recording " << job.video.string() << std::endl;
+                }
+            }
+            // Only the worker which finishes a game's last chunk merges its log, without holding up the others
+            if (--remainingChunks.at(job.video) != 0 || !recognized) continue;
+            if (BatchFiles::writeLogIfComplete(outputDirectory, job)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::cout << "Wrote " << BatchFiles::logPath(outputDirectory, job.video).string() << std::endl;
+            }
+        }
+    }
+
+    /**
+     * @brief Recognises the boards in a chunk of a recorded game.
+     *
+     * A new detector is used for each chunk, so the background learnt from one game is not used for another.
+     * In BackgroundModel mode the background is seeded with the game's first frame, the empty table,
+     * as it is when the game is analysed from the start, rather than with the chunk's first frame.
+     *
+     * @param job The chunk.
+     * @param tilePitchEstimator The worker's tile size estimate.
+     * @param textRecognizer The worker's recognizer.
+     * @param observations Receives the words on the board in each frame.
+     * @return false if the video cannot be opened.
+     */
+    bool recognizeChunk(const ChunkJob& job, TilePitchEstimator& tilePitchEstimator, TextRecognizer& textRecognizer, std::vector<BoardObservation>& observations) const {
+        cv::VideoCapture video(job.video.string());
+        if (!video.isOpened()) return false;
+        std::unique_ptr<TextDetector> textDetector{ TextDetector::createInstance(tilePitchEstimator) };
+        textDetector->setDetectionMode(detectionMode);
+
+        cv::Mat frame;
+        if (job.startFrame > 0) {
+            if (detectionMode == TextDetector::DetectionMode::BackgroundModel && video.read(frame)) textDetector->updateBackground(frame);
+            video.set(cv::CAP_PROP_POS_FRAMES, job.startFrame);
+        }
+        for (int i = job.startFrame; (job.endFrame < 0 || i < job.endFrame) && video.read(frame); ++i) {
+            if (detectionMode == TextDetector::DetectionMode::BackgroundModel) textDetector->updateBackground(frame);
+            std::vector<cv::RotatedRect> tileLocations = textDetector->getTileLocations(frame, false);
+            observations.push_back(BoardObservation{ video.get(cv::CAP_PROP_POS_MSEC) / 1000.0, textRecognizer.generateWords(frame, tileLocations) });
+        }
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,328 @@
+/**
+ * @file dynamic_letter_graph.h
+ * @brief Header file for the DynamicLetterGraph class.
+ *
+ * This file contains the declaration of the DynamicLetterGraph class, which
+ * keeps the letter node graph and its connected components, i.e. the words,
+ * up to date as tiles are added, moved and removed. The application still
+ * rebuilds the graph with TextRecognizer::connectLetterNodes for every frame
+ * it processes: updating this graph needs the same tile to keep its id from
+ * frame to frame, and there is no tile tracker yet to supply the ids.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef DYNAMIC_LETTER_GRAPH_H
+#define DYNAMIC_LETTER_GRAPH_H
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include "letter_node.h"
+#include "letter_node_utils.h"
+
+/**
+ * @struct ComponentEvent
+ * @brief Reports a connected component, i.e. a word, which changed.
+ */
+struct ComponentEvent {
+    enum class Kind { Added, Changed, Removed };
+
+    Kind kind;
+    std::size_t component;
+    std::string word; // empty for removed components
+};
+
+/**
+ * @class DynamicLetterGraph
+ * @brief Letter node graph maintained under tile insertions, moves and removals.
+ *
+ * Tiles are bucketed into grid cells, so a change only compares the tile with
+ * tiles in the neighbouring cells. Components are kept with a union-find over
+ * component labels, so merges are cheap; when a tile is removed only the tiles
+ * of its own component are searched again to find out whether it split.
+ * Listeners are told about every component which was added, changed or removed.
+ */
+class DynamicLetterGraph {
+public:
+    using TileId = std::size_t;
+    using ComponentId = std::size_t;
+    using Listener = std::function<void(const ComponentEvent&)>;
+
+    /**
+     * @brief Creates an empty graph.
+     *
+     * @param isAdjacent Function pointer to determine adjacency between nodes; it must
+     *        never hold for nodes whose centres are cellSize or further apart.
+     * @param cellSize Side length of the grid cells.
+     * @throw std::invalid_argument If cellSize is not positive.
+     */
+    DynamicLetterGraph(bool (*isAdjacent)(LetterNode, LetterNode), float cellSize) : isAdjacent(isAdjacent), cellSize(cellSize) {
+        if (!(cellSize > 0)) { throw std::invalid_argument("Cell size must be positive."); }
+    }
+
+    /**
+     * @brief Registers a function to call for every component event.
+     *
+     * @param listener Called after each change, once per affected component.
+     */
+    void addListener(Listener listener) {
+        listeners.push_back(std::move(listener));
+    }
+
+    /**
+     * @brief Adds a tile, merging any components it connects.
+     *
+     * @param id Identifier chosen by the caller, e.g. from a tile tracker.
+     * @param node The letter and location of the tile.
+     * @throw std::invalid_argument If a tile with this id already exists.
+     */
+    void addTile(TileId id, const LetterNode& node) {
+        if (tiles.contains(id)) { throw std::invalid_argument("Tile already exists."); }
+        const std::int64_t cell{ cellOf(node) };
+        Tile& tile = tiles.emplace(id, Tile{ node, newLabel(), {}, cell }).first->second;
+        cells[cell].push_back(id);
+
+        // Connect to the tiles in the neighbouring cells
+        std::vector<ComponentId> touched{};
+        forEachNearbyTile(cell, [&](TileId otherId) {
+            if (otherId == id) return;
+            Tile& other = tiles.at(otherId);
+            if (!isAdjacent(tile.node, other.node)) return;
+            tile.neighbours.insert(otherId);
+            other.neighbours.insert(id);
+            touched.push_back(find(other.label));
+        });
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+        const ComponentId own{ find(tile.label) };
+        members[own].insert(id);
+        if (touched.empty()) {
+            notify({ ComponentEvent::Kind::Added, own, getWord(own) });
+            return;
+        }
+
+        // Union the components, merging the smaller member sets into the larger
+        ComponentId root{ own };
+        std::vector<ComponentId> absorbed{};
+        for (ComponentId component : touched) {
+            ComponentId larger{ root }, smaller{ component };
+            if (std::size(members[larger]) <= std::size(members[smaller])) std::swap(larger, smaller); // the new tile never survives a tie
+            parent[smaller] = larger;
+            members[larger].merge(members[smaller]);
+            members.erase(smaller);
+            if (smaller != own) absorbed.push_back(smaller);
+            root = larger;
+        }
+        for (ComponentId component : absorbed) notify({ ComponentEvent::Kind::Removed, component, "" });
+        notify({ ComponentEvent::Kind::Changed, root, getWord(root) });
+    }
+
+    /**
+     * @brief Removes a tile, splitting its component if the tile connected parts of it.
+     *
+     * @param id Identifier of the tile.
+     * @throw std::out_of_range If there is no tile with this id.
+     */
+    void removeTile(TileId id) {
+        Tile tile{ tiles.at(id) };
+        const ComponentId component{ find(tile.label) };
+        for (TileId neighbour : tile.neighbours) tiles.at(neighbour).neighbours.erase(id);
+        std::vector<TileId>& cell = cells.at(tile.cell);
+        cell.erase(std::find(cell.begin(), cell.end(), id));
+        if (cell.empty()) cells.erase(tile.cell);
+        tiles.erase(id);
+        members[component].erase(id);
+
+        if (members[component].empty()) {
+            members.erase(component);
+            notify({ ComponentEvent::Kind::Removed, component, "" });
+            return;
+        }
+
+        // Only the tile's own component can have split, so search it again from the former neighbours
+        std::vector<std::vector<TileId>> pieces{};
+        std::unordered_set<TileId> visited{};
+        for (TileId start : tile.neighbours) {
+            if (visited.contains(start)) continue;
+            std::vector<TileId> piece{ start };
+            visited.insert(start);
+            for (std::size_t k = 0; k < std::size(piece); ++k) {
+                for (TileId next : tiles.at(piece[k]).neighbours) {
+                    if (visited.insert(next).second) piece.push_back(next);
+                }
+            }
+            pieces.push_back(std::move(piece));
+        }
+
+        // The largest piece keeps the component, the others become new components
+        std::sort(pieces.begin(), pieces.end(), [](const auto& a, const auto& b) { return std::size(a) > std::size(b); });
+        std::vector<ComponentId> added{};
+        for (std::size_t i = 1; i < std::size(pieces); ++i) {
+            const ComponentId label{ newLabel() };
+            for (TileId pieceTile : pieces[i]) {
+                tiles.at(pieceTile).label = label;
+                members[component].erase(pieceTile);
+                members[label].insert(pieceTile);
+            }
+            added.push_back(label);
+        }
+        notify({ ComponentEvent::Kind::Changed, component, getWord(component) });
+        for (ComponentId label : added) notify({ ComponentEvent::Kind::Added, label, getWord(label) });
+    }
+
+    /**
+     * @brief Moves a tile or changes its letter.
+     *
+     * Equivalent to removing the tile and adding it again at its new location.
+     *
+     * @param id Identifier of the tile.
+     * @param node The new letter and location of the tile.
+     * @throw std::out_of_range If there is no tile with this id.
+     */
+    void moveTile(TileId id, const LetterNode& node) {
+        removeTile(id);
+        addTile(id, node);
+    }
+
+    /**
+     * @param id Identifier of a tile.
+     * @return The component the tile belongs to.
+     * @throw std::out_of_range If there is no tile with this id.
+     */
+    ComponentId getComponent(TileId id) {
+        return find(tiles.at(id).label);
+    }
+
+    /**
+     * @brief The letters of a component, ordered along the principal axis of the tile centres.
+     *
+     * Words closer to horizontal read left to right and words closer to vertical read top
+     * to bottom, however noisy the centres across the word are.
+     *
+     * @param component A component id from an event or getComponent.
+     * @return The word, or an empty string if there is no such component.
+     */
+    std::string getWord(ComponentId component) const {
+        auto it = members.find(component);
+        if (it == members.end()) return "";
+        std::vector<const LetterNode*> nodes{};
+        for (TileId id : it->second) nodes.push_back(&tiles.at(id).node);
+
+        cv::Point2f mean{ 0, 0 };
+        for (const LetterNode* node : nodes) mean += node->rect.center;
+        mean *= 1.0f / static_cast<float>(std::size(nodes));
+        double xx{ 0 }, xy{ 0 }, yy{ 0 };
+        for (const LetterNode* node : nodes) {
+            const cv::Point2f d{ node->rect.center - mean };
+            xx += d.x * d.x;
+            xy += d.x * d.y;
+            yy += d.y * d.y;
+        }
+        const double angle{ 0.5 * std::atan2(2 * xy, xx - yy) };
+        cv::Point2f axis(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+        if (std::abs(axis.x) >= std::abs(axis.y) ? axis.x < 0 : axis.y < 0) axis = -axis;
+        std::sort(nodes.begin(), nodes.end(), [&axis](const LetterNode* a, const LetterNode* b) {
+            return a->rect.center.dot(axis) < b->rect.center.dot(axis);
+        });
+        std::string word{};
+        for (const LetterNode* node : nodes) word += node->letter;
+        return word;
+    }
+
+    /**
+     * @return The words of all components, in no particular order.
+     */
+    std::vector<std::string> getWords() const {
+        std::vector<std::string> words{};
+        for (const auto& [component, tileIds] : members) words.push_back(getWord(component));
+        return words;
+    }
+
+    /**
+     * @return Number of tiles in the graph.
+     */
+    std::size_t size() const {
+        return std::size(tiles);
+    }
+
+private:
+    /**
+     * @struct Tile
+     * @brief A tile, its label in the union-find and its adjacent tiles.
+     */
+    struct Tile {
+        LetterNode node;
+        ComponentId label;
+        std::unordered_set<TileId> neighbours;
+        std::int64_t cell;
+    };
+
+    bool (*isAdjacent)(LetterNode, LetterNode);
+    float cellSize;
+    std::unordered_map<TileId, Tile> tiles{};
+    std::unordered_map<std::int64_t, std::vector<TileId>> cells{};
+    std::vector<ComponentId> parent{}; // union-find over labels; a root label is a component id
+    std::unordered_map<ComponentId, std::unordered_set<TileId>> members{}; // tiles of each component
+    std::vector<Listener> listeners{};
+
+    /**
+     * @brief Creates a label which is its own component.
+     */
+    ComponentId newLabel() {
+        parent.push_back(std::size(parent));
+        return std::size(parent) - 1;
+    }
+
+    /**
+     * @brief Finds the component of a label, halving the path on the way.
+     */
+    ComponentId find(ComponentId label) {
+        while (parent[label] != label) {
+            parent[label] = parent[parent[label]];
+            label = parent[label];
+        }
+        return label;
+    }
+
+    /**
+     * @brief Key of the grid cell containing a node's centre.
+     */
+    std::int64_t cellOf(const LetterNode& node) const {
+        return cellKey(static_cast<std::int64_t>(std::floor(node.rect.center.x / cellSize)),
+            static_cast<std::int64_t>(std::floor(node.rect.center.y / cellSize)));
+    }
+
+    static std::int64_t cellKey(std::int64_t x, std::int64_t y) {
+        return (x << 32) ^ (y & 0xffffffff);
+    }
+
+    /**
+     * @brief Calls a function for every tile in a cell and the eight surrounding cells.
+     */
+    template <typename Function>
+    void forEachNearbyTile(std::int64_t cell, Function function) const {
+        const std::int64_t x{ cell >> 32 };
+        const std::int64_t y{ static_cast<std::int32_t>(cell & 0xffffffff) };
+        for (std::int64_t dx = -1; dx <= 1; ++dx) {
+            for (std::int64_t dy = -1; dy <= 1; ++dy) {
+                auto it = cells.find(cellKey(x + dx, y + dy));
+                if (it == cells.end()) continue;
+                for (TileId id : it->second) function(id);
+            }
+        }
+    }
+
+    void notify(const ComponentEvent& event) const {
+        for (const Listener& listener : listeners) listener(event);
+    }
+};
+
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file frame_arena.h
+ * @brief Header file for the FrameArena class.
+ *
+ * This file contains the declaration of the FrameArena class, which provides
+ * the memory for the transient data of one frame and releases it all at once
+ * when the frame has been processed.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+#include <cstddef>
+#include <vector>
+#include <optional>
+#include <memory_resource>
+
+/**
+ * @class FrameArena
+ * @brief Monotonic arena for the containers built while processing a frame.
+ *
+ * Allocations are bumped out of a single buffer and never freed individually;
+ * reset() releases everything at the end of the frame. If a frame needs more
+ * than the buffer holds the rest comes from the heap, and the buffer is grown
+ * on the next reset() so that later frames of the same size fit in it.
+ */
+class FrameArena {
+public:
+    /**
+     * @brief Creates an arena.
+     *
+     * @param initialCapacity Size of the buffer in bytes before it has been grown to fit a frame.
+     * @param upstream Resource for what does not fit in the buffer, e.g. std::pmr::null_memory_resource()
+     *                 to check that frames are processed without touching the heap.
+     */
+    explicit FrameArena(std::size_t initialCapacity = 256 * 1024, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : buffer(initialCapacity), overflow(upstream) {
+        arena.emplace(buffer.data(), std::size(buffer), &overflow);
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * @return The memory resource to build the frame's containers with.
+     */
+    std::pmr::memory_resource* resource() {
+        return &*arena;
+    }
+
+    /**
+     * @brief Releases everything allocated for the frame.
+     *
+     * Containers built with resource() must not be used afterwards.
+     */
+    void reset() {
+        arena->release();
+        if (overflow.bytes == 0) return;
+        buffer = std::vector<std::byte>(std::size(buffer) + overflow.bytes);
+        arena.emplace(buffer.data(), std::size(buffer), &overflow);
+        overflow.bytes = 0;
+        ++growCount;
+    }
+
+    /**
+     * @return Size of the buffer in bytes.
+     */
+    std::size_t capacity() const {
+        return std::size(buffer);
+    }
+
+    /**
+     * @return Number of times a frame did not fit in the buffer, which should stop growing after the first few frames.
+     */
+    std::size_t getGrowCount() const {
+        return growCount;
+    }
+
+private:
+    /**
+     * @class OverflowResource
+     * @brief Upstream resource which counts the bytes the arena needed beyond its buffer.
+     */
+    class OverflowResource : public std::pmr::memory_resource {
+    public:
+        std::size_t bytes{ 0 };
+
+        explicit OverflowResource(std::pmr::memory_resource* upstream) : upstream(upstream) {}
+
+    private:
+        std::pmr::memory_resource* upstream;
+
+        void* do_allocate(std::size_t size, std::size_t alignment) override {
+            void* p{ upstream->allocate(size, alignment) };
+            bytes += size;
+            return p;
+        }
+
+        void do_deallocate(void* p, std::size_t size, std::size_t alignment) override {
+            upstream->deallocate(p, size, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    std::vector<std::byte> buffer;
+    OverflowResource overflow;
+    std::optional<std::pmr::monotonic_buffer_resource> arena{};
+    std::size_t growCount{ 0 };
+};
+
+#endif
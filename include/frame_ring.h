@@ -0,0 +1,151 @@
+/**
+ * @file frame_ring.h
+ * @brief Header file for the FrameRing class.
+ *
+ * This file contains the declaration of the FrameRing class, which keeps the
+ * most recent camera frames together with a sharpness score so the sharpest
+ * one can be processed instead of whichever frame happened to be last.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+#include <vector>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class FrameRing
+ * @brief Ring of recent frames scored by sharpness.
+ *
+ * Frames are copied into buffers which are reused once the ring is full, so
+ * pushing a frame of the usual size does not allocate.
+ */
+class FrameRing {
+public:
+    /**
+     * @brief Creates an empty ring.
+     *
+     * @param capacity Number of recent frames kept.
+     * @throw std::invalid_argument If capacity is 0.
+     */
+    explicit FrameRing(std::size_t capacity = 8) : frames(capacity) {
+        if (capacity == 0) { throw std::invalid_argument("FrameRing capacity must be positive."); }
+    }
+
+    /**
+     * @brief Adds a frame, replacing the oldest one if the ring is full.
+     *
+     * @param frame The raw frame from the video camera.
+     */
+    void push(const cv::Mat& frame) {
+        push(frame, sharpness(frame));
+    }
+
+    /**
+     * @brief Adds a frame which was scored elsewhere, e.g. an undecoded frame scored on its luma.
+     *
+     * @param frame The frame to keep.
+     * @param frameSharpness Its sharpness score, higher is sharper.
+     */
+    void push(const cv::Mat& frame, double frameSharpness) {
+        ScoredFrame& slot = frames[next];
+        frame.copyTo(slot.frame);
+        slot.sharpness = frameSharpness;
+        next = (next + 1) % std::size(frames);
+        count = std::min(count + 1, std::size(frames));
+    }
+
+    /**
+     * @return Number of frames held.
+     */
+    std::size_t size() const {
+        return count;
+    }
+
+    /**
+     * @return true if no frames have been pushed.
+     */
+    bool empty() const {
+        return count == 0;
+    }
+
+    /**
+     * @return The sharpest of the recent frames.
+     * @throw std::runtime_error If the ring is empty.
+     */
+    const cv::Mat& getSharpest() const {
+        if (empty()) { throw std::runtime_error("No frames captured."); }
+        const ScoredFrame* sharpest = &frames[0];
+        for (std::size_t i = 1; i < count; ++i) {
+            if (frames[i].sharpness > sharpest->sharpness) { sharpest = &frames[i]; }
+        }
+        return sharpest->frame;
+    }
+
+    /**
+     * @return The recent frames, oldest first. They share their data with the ring,
+     *         so clone them to keep them past the next push.
+     */
+    std::vector<cv::Mat> getFrames() const {
+        std::vector<cv::Mat> recentFrames{};
+        recentFrames.reserve(count);
+        const std::size_t oldest{ (next + std::size(frames) - count) % std::size(frames) };
+        for (std::size_t i = 0; i < count; ++i) {
+            recentFrames.push_back(frames[(oldest + i) % std::size(frames)].frame);
+        }
+        return recentFrames;
+    }
+
+    /**
+     * @return The recent frames other than the sharpest one, oldest first, e.g. to fuse
+     *         with the sharpest frame without counting it twice. They share their data
+     *         with the ring, so clone them to keep them past the next push.
+     */
+    std::vector<cv::Mat> getFramesExceptSharpest() const {
+        std::vector<cv::Mat> recentFrames{ getFrames() };
+        if (empty()) return recentFrames;
+        const uchar* sharpest{ getSharpest().data };
+        std::erase_if(recentFrames, [sharpest](const cv::Mat& frame) { return frame.data == sharpest; });
+        return recentFrames;
+    }
+
+    /**
+     * @brief Cheap sharpness score of a frame.
+     *
+     * Variance of the Laplacian of the centre of the frame at half resolution;
+     * motion blur removes the edges which give a high variance.
+     *
+     * @param frame The raw frame from the video camera.
+     * @return The sharpness score, higher is sharper.
+     */
+    static double sharpness(const cv::Mat& frame) {
+        if (frame.empty()) return 0;
+        const cv::Rect centre(frame.cols / 4, frame.rows / 4, std::max(1, frame.cols / 2), std::max(1, frame.rows / 2));
+        cv::Mat small;
+        cv::resize(frame(centre), small, cv::Size(), 0.5, 0.5, cv::INTER_AREA);
+        if (small.channels() == 3) cv::cvtColor(small, small, cv::COLOR_BGR2GRAY);
+        cv::Mat laplacian;
+        cv::Laplacian(small, laplacian, CV_16S);
+        cv::Scalar mean, stddev;
+        cv::meanStdDev(laplacian, mean, stddev);
+        return stddev[0] * stddev[0];
+    }
+
+private:
+    /**
+     * @struct ScoredFrame
+     * @brief A frame and its sharpness score.
+     */
+    struct ScoredFrame {
+        cv::Mat frame;
+        double sharpness{ 0 };
+    };
+
+    std::vector<ScoredFrame> frames;
+    std::size_t next{ 0 }; // slot the next frame is written to
+    std::size_t count{ 0 };
+};
+
+#endif
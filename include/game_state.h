@@ -0,0 +1,243 @@
+/**
+ * @file game_state.h
+ * @brief Header file for immutable snapshots of the game state.
+ *
+ * This file contains the declaration of the GameState class, an immutable
+ * snapshot of the words on the board whose versions share structure, and
+ * the GameStateStore class which publishes the latest snapshot to any
+ * number of concurrent readers.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef GAME_STATE_H
+#define GAME_STATE_H
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+/**
+ * @class PersistentVector
+ * @brief Immutable vector whose modified copies share unmodified storage.
+ *
+ * Elements live in fixed size chunks held by shared pointers. Modifying an
+ * element copies only its chunk and the small table of chunk pointers, so
+ * successive versions share almost all of their elements.
+ */
+template <typename T>
+class PersistentVector {
+public:
+    static constexpr std::size_t chunkSize{ 32 };
+    using Chunk = std::vector<T>;
+
+    /**
+     * @return Number of elements.
+     */
+    std::size_t size() const {
+        return count;
+    }
+
+    /**
+     * @return true if there are no elements.
+     */
+    bool empty() const {
+        return count == 0;
+    }
+
+    /**
+     * @param i Index of the element.
+     * @return The element at index i.
+     * @throw std::out_of_range If i is not less than size().
+     */
+    const T& at(std::size_t i) const {
+        if (i >= count) { throw std::out_of_range("PersistentVector index out of range."); }
+        return (*chunks[i / chunkSize])[i % chunkSize];
+    }
+
+    /**
+     * @brief Returns a copy with an element appended.
+     */
+    PersistentVector pushBack(T value) const {
+        PersistentVector next{ *this };
+        if (count % chunkSize == 0) {
+            auto chunk = std::make_shared<Chunk>();
+            chunk->reserve(chunkSize);
+            chunk->push_back(std::move(value));
+            next.chunks.push_back(std::move(chunk));
+        }
+        else {
+            auto chunk = std::make_shared<Chunk>(*chunks.back());
+            chunk->push_back(std::move(value));
+            next.chunks.back() = std::move(chunk);
+        }
+        ++next.count;
+        return next;
+    }
+
+    /**
+     * @brief Returns a copy with the element at index i replaced.
+     * @throw std::out_of_range If i is not less than size().
+     */
+    PersistentVector set(std::size_t i, T value) const {
+        if (i >= count) { throw std::out_of_range("PersistentVector index out of range."); }
+        PersistentVector next{ *this };
+        auto chunk = std::make_shared<Chunk>(*chunks[i / chunkSize]);
+        (*chunk)[i % chunkSize] = std::move(value);
+        next.chunks[i / chunkSize] = std::move(chunk);
+        return next;
+    }
+
+    /**
+     * @brief Returns a copy without the element at index i.
+     *
+     * The last element takes the place of the removed one, so only two chunks are copied.
+     *
+     * @throw std::out_of_range If i is not less than size().
+     */
+    PersistentVector eraseUnordered(std::size_t i) const {
+        if (i >= count) { throw std::out_of_range("PersistentVector index out of range."); }
+        PersistentVector next{ i + 1 == count ? *this : set(i, at(count - 1)) };
+        auto last = std::make_shared<Chunk>(*next.chunks.back());
+        last->pop_back();
+        if (last->empty()) {
+            next.chunks.pop_back();
+        }
+        else {
+            next.chunks.back() = std::move(last);
+        }
+        --next.count;
+        return next;
+    }
+
+    /**
+     * @param chunkIndex Index of a chunk.
+     * @return The storage of that chunk, to check what versions share.
+     */
+    const Chunk* getChunk(std::size_t chunkIndex) const {
+        return chunks[chunkIndex].get();
+    }
+
+private:
+    std::vector<std::shared_ptr<const Chunk>> chunks{};
+    std::size_t count{ 0 };
+};
+
+/**
+ * @class GameState
+ * @brief Immutable snapshot of the words on the board.
+ *
+ * Updates return a new snapshot with the next version number which shares
+ * storage with this one, so keeping old snapshots alive is cheap.
+ */
+class GameState {
+public:
+    GameState() = default;
+
+    /**
+     * @return Version number, incremented by every update.
+     */
+    std::uint64_t getVersion() const {
+        return version;
+    }
+
+    /**
+     * @return The words on the board.
+     */
+    const PersistentVector<std::string>& getWords() const {
+        return words;
+    }
+
+    /**
+     * @return A copy of the words on the board, e.g. for the solver.
+     */
+    std::vector<std::string> getWordList() const {
+        std::vector<std::string> wordList{};
+        wordList.reserve(words.size());
+        for (std::size_t i = 0; i < words.size(); ++i) { wordList.push_back(words.at(i)); }
+        return wordList;
+    }
+
+    /**
+     * @brief Returns the next snapshot, with a word placed on the board.
+     */
+    GameState withWordAdded(std::string word) const {
+        return GameState{ version + 1, words.pushBack(std::move(word)) };
+    }
+
+    /**
+     * @brief Returns the next snapshot, with the word at index i replaced, e.g. after a snatch.
+     */
+    GameState withWordReplaced(std::size_t i, std::string word) const {
+        return GameState{ version + 1, words.set(i, std::move(word)) };
+    }
+
+    /**
+     * @brief Returns the next snapshot, with the word at index i removed.
+     *
+     * The last word takes the index of the removed one.
+     */
+    GameState withWordRemoved(std::size_t i) const {
+        return GameState{ version + 1, words.eraseUnordered(i) };
+    }
+
+private:
+    std::uint64_t version{ 0 };
+    PersistentVector<std::string> words{};
+
+    GameState(std::uint64_t version, PersistentVector<std::string> words) : version(version), words(std::move(words)) {}
+};
+
+/**
+ * @class GameStateStore
+ * @brief Publishes the latest GameState to concurrent readers.
+ *
+ * Readers take a snapshot with an atomic load and keep reading it for as long
+ * as they like, without locks or copies, while the writer publishes newer
+ * snapshots. Updates are expected to come from a single writer. The application
+ * does not publish snapshots yet; its main loop still hands each frame's words
+ * straight to the solver.
+ */
+class GameStateStore {
+public:
+    GameStateStore() : current(std::make_shared<const GameState>()) {}
+
+    GameStateStore(const GameStateStore&) = delete;
+    GameStateStore& operator=(const GameStateStore&) = delete;
+
+    /**
+     * @return The latest snapshot.
+     */
+    std::shared_ptr<const GameState> load() const {
+        return current.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Makes a snapshot the latest one.
+     *
+     * @param state The new snapshot.
+     */
+    void publish(GameState state) {
+        current.store(std::make_shared<const GameState>(std::move(state)), std::memory_order_release);
+    }
+
+    /**
+     * @brief Publishes the result of applying an update to the latest snapshot.
+     *
+     * @param update Callable taking the latest GameState and returning the next one.
+     * @return The published snapshot.
+     */
+    template <typename Update>
+    std::shared_ptr<const GameState> update(Update update) {
+        auto next = std::make_shared<const GameState>(update(*load()));
+        current.store(next, std::memory_order_release);
+        return next;
+    }
+
+private:
+    std::atomic<std::shared_ptr<const GameState>> current;
+};
+
+#endif
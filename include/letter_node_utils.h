@@ -10,10 +10,161 @@
 
 #ifndef LETTER_NODE_UTILS_H
 #define LETTER_NODE_UTILS_H
+#include <cmath>
+#include <span>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory_resource>
 #include <unordered_map>
 #include <unordered_set>
+#include "letter_node.h"
 
 namespace LetterNodeUtils {
+    /**
+     * @brief Distance between tile centres, in tile side lengths, below which tiles are in the same word.
+     *
+     * Neighbours in a word are one side length and a small gap apart, tiles diagonal
+     * to each other are sqrt(2) side lengths apart.
+     */
+    inline constexpr float adjacencyInTileSizes{ 1.3f };
+
+    /**
+     * @brief Letter node graph whose nodes and sets are allocated from a memory resource, e.g. a FrameArena.
+     */
+    using PmrLetterNodeGraph = std::pmr::unordered_map<LetterNode, std::pmr::unordered_set<LetterNode>>;
+
+    namespace detail {
+        /**
+         * @brief Adds an edge between every adjacent pair of nodes to a graph.
+         */
+        template <typename Graph>
+        void connectAllPairs(std::span<const LetterNode> letterNodes, bool (*isAdjacent)(LetterNode, LetterNode), Graph& graph) {
+            for (const LetterNode& u : letterNodes) {
+                for (const LetterNode& v : letterNodes) {
+                    if (isAdjacent(u, v)) {
+                        graph[u].insert(v);
+                        graph[v].insert(u);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Calls a function for every adjacent pair of nodes in neighbouring grid cells.
+         *
+         * @param cells An empty map from cell key to the nodes in the cell, used as scratch space.
+         * @param onAdjacent Called with references into letterNodes of each adjacent pair, in both orders.
+         */
+        template <typename Cells, typename OnAdjacent>
+        void forEachAdjacentPair(std::span<const LetterNode> letterNodes, bool (*isAdjacent)(LetterNode, LetterNode), float cellSize, Cells& cells, OnAdjacent onAdjacent) {
+            auto cellKey = [](std::int64_t x, std::int64_t y) { return (x << 32) ^ (y & 0xffffffff); };
+            for (const LetterNode& u : letterNodes) {
+                const std::int64_t x{ static_cast<std::int64_t>(std::floor(u.rect.center.x / cellSize)) };
+                const std::int64_t y{ static_cast<std::int64_t>(std::floor(u.rect.center.y / cellSize)) };
+                cells[cellKey(x, y)].push_back(&u);
+            }
+
+            for (const LetterNode& u : letterNodes) {
+                const std::int64_t x{ static_cast<std::int64_t>(std::floor(u.rect.center.x / cellSize)) };
+                const std::int64_t y{ static_cast<std::int64_t>(std::floor(u.rect.center.y / cellSize)) };
+                for (std::int64_t dx = -1; dx <= 1; ++dx) {
+                    for (std::int64_t dy = -1; dy <= 1; ++dy) {
+                        auto cell = cells.find(cellKey(x + dx, y + dy));
+                        if (cell == cells.end()) continue;
+                        for (const LetterNode* v : cell->second) {
+                            if (isAdjacent(u, *v)) onAdjacent(u, *v);
+                        }
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Adds an edge between adjacent nodes in neighbouring grid cells to a graph.
+         *
+         * @param cells An empty map from cell key to the nodes in the cell, used as scratch space.
+         */
+        template <typename Graph, typename Cells>
+        void connectNeighbouringCells(std::span<const LetterNode> letterNodes, bool (*isAdjacent)(LetterNode, LetterNode), float cellSize, Cells& cells, Graph& graph) {
+            forEachAdjacentPair(letterNodes, isAdjacent, cellSize, cells, [&graph](const LetterNode& u, const LetterNode& v) {
+                graph[u].insert(v);
+                graph[v].insert(u);
+            });
+        }
+
+        /**
+         * @brief Groups connected nodes by union-find, see LetterNodeUtils::groupConnectedNodes.
+         *
+         * @param parent Scratch space with one element per node.
+         * @param groupIndex Scratch space with one element per node.
+         * @param cells An empty map from cell key to the nodes in the cell, used as scratch space.
+         * @param groups Receives the indices of the nodes in each group.
+         */
+        template <typename Indices, typename Cells, typename Groups>
+        void groupConnectedNodes(std::span<const LetterNode> letterNodes, bool (*isAdjacent)(LetterNode, LetterNode), float cellSize,
+            Indices& parent, Indices& groupIndex, Cells& cells, Groups& groups) {
+            for (std::size_t i = 0; i < std::size(parent); ++i) parent[i] = i;
+            auto find = [&parent](std::size_t i) {
+                while (parent[i] != i) i = parent[i] = parent[parent[i]];
+                return i;
+            };
+            auto unite = [&](const LetterNode& u, const LetterNode& v) {
+                const std::size_t rootU{ find(static_cast<std::size_t>(&u - letterNodes.data())) };
+                const std::size_t rootV{ find(static_cast<std::size_t>(&v - letterNodes.data())) };
+                parent[std::max(rootU, rootV)] = std::min(rootU, rootV); // the root is the group's first node
+            };
+            if (cellSize > 0) {
+                forEachAdjacentPair(letterNodes, isAdjacent, cellSize, cells, unite);
+            }
+            else {
+                for (const LetterNode& u : letterNodes) {
+                    for (const LetterNode& v : letterNodes) {
+                        if (isAdjacent(u, v)) unite(u, v);
+                    }
+                }
+            }
+
+            for (std::size_t i = 0; i < std::size(letterNodes); ++i) {
+                const std::size_t root{ find(i) };
+                if (root == i) {
+                    groupIndex[i] = std::size(groups);
+                    groups.emplace_back();
+                }
+                groups[groupIndex[root]].push_back(i);
+            }
+        }
+
+        /**
+         * @brief Depth first search appending the letters of a connected component to a word.
+         */
+        template <typename Graph, typename Visited, typename Word>
+        void dfs(const LetterNode u, const Graph& graph, Visited& visited, Word& word) {
+            visited.insert(u);
+            word += u.letter;
+            for (const LetterNode& v : graph.at(u)) {
+                if (!visited.contains(v)) dfs(v, graph, visited, word);
+            }
+        }
+
+        /**
+         * @brief Appends one word per connected component of a graph.
+         *
+         * @param makeWord Creates an empty word.
+         */
+        template <typename Graph, typename Visited, typename Words, typename MakeWord>
+        void collectComponents(const Graph& graph, Visited& visited, Words& words, MakeWord makeWord) {
+            for (const auto& x : graph) {
+                LetterNode u = x.first;
+                if (visited.contains(u)) continue;
+                auto word = makeWord();
+                dfs(u, graph, visited, word);
+                words.push_back(std::move(word));
+            }
+        }
+    }
+
     /**
      * @brief Creates a graph of LetterNodes based on adjacency.
      *
@@ -25,17 +176,25 @@ namespace LetterNodeUtils {
      * @return A graph represented as an unordered_map, where each LetterNode is mapped
      *         to its set of adjacent LetterNodes.
      */
-    std::unordered_map<LetterNode, std::unordered_set<LetterNode>> createLetterNodeGraph(
+    inline std::unordered_map<LetterNode, std::unordered_set<LetterNode>> createLetterNodeGraph(
         const std::vector<LetterNode>& letterNodes, bool (*isAdjacent)(LetterNode, LetterNode)) {
         std::unordered_map<LetterNode, std::unordered_set<LetterNode>> graph;
-        for (const LetterNode& u : letterNodes) {
-            for (const LetterNode& v : letterNodes) {
-                if (isAdjacent(u, v)) {
-                    graph[u].insert(v);
-                    graph[v].insert(u);
-                }
-            }
-        }
+        detail::connectAllPairs(letterNodes, isAdjacent, graph);
+        return graph;
+    }
+
+    /**
+     * @brief Creates a graph of LetterNodes based on adjacency, allocated from a memory resource.
+     *
+     * @param letterNodes The LetterNodes to be connected in the graph.
+     * @param isAdjacent Function pointer to determine adjacency between nodes.
+     * @param resource Memory resource for the graph, e.g. a FrameArena.
+     * @return A graph where each LetterNode is mapped to its set of adjacent LetterNodes.
+     */
+    inline PmrLetterNodeGraph createLetterNodeGraph(std::span<const LetterNode> letterNodes, bool (*isAdjacent)(LetterNode, LetterNode),
+        std::pmr::memory_resource* resource) {
+        PmrLetterNodeGraph graph{ resource };
+        detail::connectAllPairs(letterNodes, isAdjacent, graph);
         return graph;
     }
 
@@ -49,7 +208,7 @@ namespace LetterNodeUtils {
      * @param v Another letter node.
      * @return A bool indicating whether they are adjacent or not.
      */
-    bool boundingBoxAdjacencyStrategy(LetterNode u, LetterNode v) {
+    inline bool boundingBoxAdjacencyStrategy(LetterNode u, LetterNode v) {
         cv::Point2f pointsU[4];
         cv::Point2f pointsV[4];
         u.rect.points(pointsU); // Get the 4 corners of the first rectangle
@@ -65,6 +224,115 @@ namespace LetterNodeUtils {
         return boundingBox.size.area() < threshold;
     }
 
+    /**
+     * @brief Creates a graph of LetterNodes, only comparing nodes in neighbouring grid cells.
+     *
+     * The nodes are bucketed into square cells by their centre, so each node is only
+     * compared with the nodes in its own and the eight surrounding cells.
+     *
+     * @param letterNodes A vector of LetterNodes to be connected in the graph.
+     * @param isAdjacent Function pointer to determine adjacency between nodes; it must
+     *        never hold for nodes whose centres are cellSize or further apart.
+     * @param cellSize Side length of the grid cells.
+     * @return A graph represented as an unordered_map, where each LetterNode is mapped
+     *         to its set of adjacent LetterNodes.
+     */
+    inline std::unordered_map<LetterNode, std::unordered_set<LetterNode>> createLetterNodeGraph(
+        const std::vector<LetterNode>& letterNodes, bool (*isAdjacent)(LetterNode, LetterNode), float cellSize) {
+        std::unordered_map<std::int64_t, std::vector<const LetterNode*>> cells;
+        std::unordered_map<LetterNode, std::unordered_set<LetterNode>> graph;
+        detail::connectNeighbouringCells(letterNodes, isAdjacent, cellSize, cells, graph);
+        return graph;
+    }
+
+    /**
+     * @brief Creates a graph of LetterNodes from neighbouring grid cells, allocated from a memory resource.
+     *
+     * @param letterNodes The LetterNodes to be connected in the graph.
+     * @param isAdjacent Function pointer to determine adjacency between nodes; it must
+     *        never hold for nodes whose centres are cellSize or further apart.
+     * @param cellSize Side length of the grid cells.
+     * @param resource Memory resource for the graph and the cells, e.g. a FrameArena.
+     * @return A graph where each LetterNode is mapped to its set of adjacent LetterNodes.
+     */
+    inline PmrLetterNodeGraph createLetterNodeGraph(std::span<const LetterNode> letterNodes, bool (*isAdjacent)(LetterNode, LetterNode),
+        float cellSize, std::pmr::memory_resource* resource) {
+        std::pmr::unordered_map<std::int64_t, std::pmr::vector<const LetterNode*>> cells{ resource };
+        PmrLetterNodeGraph graph{ resource };
+        detail::connectNeighbouringCells(letterNodes, isAdjacent, cellSize, cells, graph);
+        return graph;
+    }
+
+    /**
+     * @brief Computes the adjacency of two letter nodes from their own sizes.
+     *
+     * Two nodes are adjacent if their centres are closer than adjacencyInTileSizes
+     * times their mean side length. Like boundingBoxAdjacencyStrategy it does not
+     * depend on the scale, so tiles near and far from a tilted camera are grouped
+     * alike, but it only needs the distance between the centres.
+     *
+     * @param u A letter node.
+     * @param v Another letter node.
+     * @return A bool indicating whether they are adjacent or not.
+     */
+    inline bool pitchAdjacencyStrategy(LetterNode u, LetterNode v) {
+        const float meanSide{ 0.5f * (std::sqrt(u.rect.size.area()) + std::sqrt(v.rect.size.area())) };
+        return cv::norm(u.rect.center - v.rect.center) < adjacencyInTileSizes * meanSide;
+    }
+
+    /**
+     * @brief Grid cell size for which pitchAdjacencyStrategy only holds between neighbouring cells.
+     *
+     * @param letterNodes The LetterNodes to be connected in the graph.
+     * @return The adjacency distance of the largest node, or 0 if there are no nodes.
+     */
+    inline float pitchAdjacencyCellSize(std::span<const LetterNode> letterNodes) {
+        float largestSide{ 0 };
+        for (const LetterNode& letterNode : letterNodes) largestSide = std::max(largestSide, std::sqrt(letterNode.rect.size.area()));
+        return adjacencyInTileSizes * largestSide;
+    }
+
+    /**
+     * @brief Groups the nodes which are connected by adjacency, keeping track of which node is which.
+     *
+     * Unlike findConnectedComponents, identical nodes are kept apart and the groups
+     * are of indices, e.g. into the tiles the nodes were made from.
+     *
+     * @param letterNodes The LetterNodes to be grouped.
+     * @param isAdjacent Function pointer to determine adjacency between nodes; it must
+     *        never hold for nodes whose centres are cellSize or further apart.
+     * @param cellSize Side length of the grid cells, or 0 to compare every pair of nodes.
+     * @return Indices into letterNodes of the nodes in each group, in order of their first node.
+     */
+    inline std::vector<std::vector<std::size_t>> groupConnectedNodes(std::span<const LetterNode> letterNodes, bool (*isAdjacent)(LetterNode, LetterNode), float cellSize) {
+        std::vector<std::size_t> parent(std::size(letterNodes));
+        std::vector<std::size_t> groupIndex(std::size(letterNodes));
+        std::unordered_map<std::int64_t, std::vector<const LetterNode*>> cells;
+        std::vector<std::vector<std::size_t>> groups{};
+        detail::groupConnectedNodes(letterNodes, isAdjacent, cellSize, parent, groupIndex, cells, groups);
+        return groups;
+    }
+
+    /**
+     * @brief Groups the nodes which are connected by adjacency, allocated from a memory resource.
+     *
+     * @param letterNodes The LetterNodes to be grouped.
+     * @param isAdjacent Function pointer to determine adjacency between nodes; it must
+     *        never hold for nodes whose centres are cellSize or further apart.
+     * @param cellSize Side length of the grid cells, or 0 to compare every pair of nodes.
+     * @param resource Memory resource for the groups and the search, e.g. a FrameArena.
+     * @return Indices into letterNodes of the nodes in each group, in order of their first node.
+     */
+    inline std::pmr::vector<std::pmr::vector<std::size_t>> groupConnectedNodes(std::span<const LetterNode> letterNodes, bool (*isAdjacent)(LetterNode, LetterNode),
+        float cellSize, std::pmr::memory_resource* resource) {
+        std::pmr::vector<std::size_t> parent(std::size(letterNodes), resource);
+        std::pmr::vector<std::size_t> groupIndex(std::size(letterNodes), resource);
+        std::pmr::unordered_map<std::int64_t, std::pmr::vector<const LetterNode*>> cells{ resource };
+        std::pmr::vector<std::pmr::vector<std::size_t>> groups{ resource };
+        detail::groupConnectedNodes(letterNodes, isAdjacent, cellSize, parent, groupIndex, cells, groups);
+        return groups;
+    }
+
     /**
      * @brief Helper function to perform depth first search on a graph node.
      * 
@@ -75,17 +343,8 @@ namespace LetterNodeUtils {
      * @param visited Nodes which have been visited and therefore do not want to visit again.
      * @param word Representing a connected component within the graph.
      */
-    void dfs(const LetterNode u, const std::unordered_map<LetterNode, std::unordered_set<LetterNode>>& graph, std::unordered_set<LetterNode>& visited, std::string& word) {
-        visited.insert(u);
-        word += u.letter;
-        for (const LetterNode& v : graph.at(u)) {
-            if (visited.contains(v)) {
-                continue;
-            }
-            else {
-                dfs(v, graph, visited, word);
-            }
-        }
+    inline void dfs(const LetterNode u, const std::unordered_map<LetterNode, std::unordered_set<LetterNode>>& graph, std::unordered_set<LetterNode>& visited, std::string& word) {
+        detail::dfs(u, graph, visited, word);
     }
 
     /**
@@ -97,20 +356,24 @@ namespace LetterNodeUtils {
      * @param graph An adjacency representation of a graph.
      * @return A vector of words representing the connected components.
      */
-    std::vector<std::string> findConnectedComponents(const std::unordered_map<LetterNode, std::unordered_set<LetterNode>>& graph) {
+    inline std::vector<std::string> findConnectedComponents(const std::unordered_map<LetterNode, std::unordered_set<LetterNode>>& graph) {
         std::unordered_set<LetterNode> visited{};
         std::vector<std::string> words{};
-        for (const auto& x : graph) {
-            LetterNode u = x.first;
-            if (visited.contains(u)) { 
-                continue;
-            }
-            else {
-                std::string word = "";
-                dfs(u, graph, visited, word);
-                words.push_back(word);
-            }
-        }
+        detail::collectComponents(graph, visited, words, []() { return std::string{}; });
+        return words;
+    }
+
+    /**
+     * @brief Converts a letter node graph into its connected components, allocated from a memory resource.
+     *
+     * @param graph An adjacency representation of a graph.
+     * @param resource Memory resource for the words and the search, e.g. a FrameArena.
+     * @return A vector of words representing the connected components.
+     */
+    inline std::pmr::vector<std::pmr::string> findConnectedComponents(const PmrLetterNodeGraph& graph, std::pmr::memory_resource* resource) {
+        std::pmr::unordered_set<LetterNode> visited{ resource };
+        std::pmr::vector<std::pmr::string> words{ resource };
+        detail::collectComponents(graph, visited, words, [resource]() { return std::pmr::string{ resource }; });
         return words;
     }
 }
@@ -0,0 +1,152 @@
+/**
+ * @file lexicon_overlay.h
+ * @brief Header file for the LexiconOverlay class.
+ *
+ * Contains the declaration of the LexiconOverlay class, a small layer of
+ * house rules (extra words and banned words) applied on top of an
+ * immutable AnagramIndex without rebuilding it.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef LEXICON_OVERLAY_H
+#define LEXICON_OVERLAY_H
+#include <bitset>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include "anagram_index.h"
+
+/**
+ * @class LexiconOverlay
+ * @brief House rule additions and tombstones layered over an AnagramIndex.
+ *
+ * Added words are grouped into their own anagram classes. Every sorted word
+ * touched by the overlay is recorded in a small Bloom filter, so lookups for
+ * the vast majority of classes are rejected without a hash table probe.
+ */
+class LexiconOverlay {
+public:
+    /**
+     * @brief Accepts a word which may be missing from the base word lists.
+     *
+     * @param word The word to accept; it is converted to uppercase.
+     * @param lexicons The word lists the word is treated as belonging to.
+     * @return false if the word could never be snatched.
+     */
+    bool allowWord(std::string word, LexiconMask lexicons) {
+        std::string sortedWord;
+        LetterCounts counts{};
+        if (!AnagramIndex::normalizeWord(word, sortedWord, counts)) { return false; }
+        bannedWords.erase(word);
+
+        auto [it, inserted] = sortedWordToClass.try_emplace(sortedWord, std::size(addedClasses));
+        if (inserted) {
+            addedClasses.push_back(AnagramClass{ sortedWord, counts, {}, {}, 0 });
+        }
+        AnagramClass& anagramClass = addedClasses[it->second];
+        anagramClass.lexiconMask |= lexicons;
+        auto existing = std::find(anagramClass.anagrams.begin(), anagramClass.anagrams.end(), word);
+        if (existing != anagramClass.anagrams.end()) {
+            anagramClass.lexicons[existing - anagramClass.anagrams.begin()] |= lexicons;
+        }
+        else {
+            anagramClass.anagrams.push_back(word);
+            anagramClass.lexicons.push_back(lexicons);
+        }
+        addToFilter(sortedWord);
+        return true;
+    }
+
+    /**
+     * @brief Bans a word from every word list, including words added by allowWord.
+     *
+     * @param word The word to ban; it is converted to uppercase.
+     * @return false if the word could never be snatched anyway.
+     */
+    bool banWord(std::string word) {
+        std::string sortedWord;
+        LetterCounts counts{};
+        if (!AnagramIndex::normalizeWord(word, sortedWord, counts)) { return false; }
+        bannedWords.insert(word);
+
+        auto it = sortedWordToClass.find(sortedWord);
+        if (it != sortedWordToClass.end()) {
+            AnagramClass& anagramClass = addedClasses[it->second];
+            auto existing = std::find(anagramClass.anagrams.begin(), anagramClass.anagrams.end(), word);
+            if (existing != anagramClass.anagrams.end()) {
+                anagramClass.lexicons.erase(anagramClass.lexicons.begin() + (existing - anagramClass.anagrams.begin()));
+                anagramClass.anagrams.erase(existing);
+                anagramClass.lexiconMask = 0;
+                for (LexiconMask lexicons : anagramClass.lexicons) { anagramClass.lexiconMask |= lexicons; }
+            }
+        }
+        addToFilter(sortedWord);
+        return true;
+    }
+
+    /**
+     * @return true if the overlay changes nothing.
+     */
+    bool empty() const {
+        return addedClasses.empty() && bannedWords.empty();
+    }
+
+    /**
+     * @brief Quick check of whether the overlay may change an anagram class.
+     *
+     * @param sortedWord Uppercase letters in sorted order.
+     * @return false if the overlay definitely leaves the class alone.
+     */
+    bool mayAffect(std::string_view sortedWord) const {
+        const std::size_t h{ std::hash<std::string_view>()(sortedWord) };
+        return filter.test(h % filterBits) && filter.test((h >> (4 * sizeof(std::size_t))) % filterBits);
+    }
+
+    /**
+     * @brief Looks up the words added with the same letters as a sorted string.
+     *
+     * @param sortedWord Uppercase letters in sorted order.
+     * @return Pointer to the added class, or nullptr if no words were added.
+     */
+    const AnagramClass* findAddedClass(std::string_view sortedWord) const {
+        auto it = sortedWordToClass.find(sortedWord);
+        return it == sortedWordToClass.end() ? nullptr : &addedClasses[it->second];
+    }
+
+    /**
+     * @return All classes of added words.
+     */
+    const std::vector<AnagramClass>& getAddedClasses() const {
+        return addedClasses;
+    }
+
+    /**
+     * @param word Uppercase word.
+     * @return true if the word has been banned.
+     */
+    bool isBanned(const std::string& word) const {
+        return bannedWords.contains(word);
+    }
+
+private:
+    static constexpr std::size_t filterBits{ 4096 };
+    std::vector<AnagramClass> addedClasses;
+    std::unordered_map<std::string, std::size_t, StringHash, std::equal_to<>> sortedWordToClass;
+    std::unordered_set<std::string> bannedWords;
+    std::bitset<filterBits> filter;
+
+    /**
+     * @brief Records a sorted word in the Bloom filter.
+     */
+    void addToFilter(const std::string& sortedWord) {
+        const std::size_t h{ std::hash<std::string_view>()(sortedWord) };
+        filter.set(h % filterBits);
+        filter.set((h >> (4 * sizeof(std::size_t))) % filterBits);
+    }
+};
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file luma_capture.h
+ * @brief Header file for the LumaCapture class.
+ *
+ * This file contains the declaration of the LumaCapture class, which reads
+ * undecoded frames from the camera so that the detector can work on reduced
+ * scale luma while full resolution pixels are only decoded around the tiles.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef LUMA_CAPTURE_H
+#define LUMA_CAPTURE_H
+#include <vector>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class LumaCapture
+ * @brief Reads undecoded camera frames and decodes only what the pipeline needs.
+ *
+ * For YUYV and NV12 streams the luma is read straight out of the Y samples. For
+ * MJPEG streams the JPEG decoder produces grayscale at half scale directly, skipping
+ * the chroma and most of the inverse DCT work. If the backend ignores the request
+ * for undecoded frames the BGR frames it returns are converted instead.
+ */
+class LumaCapture {
+public:
+    /**
+     * @brief Pixel format requested from the camera.
+     */
+    enum class StreamFormat { Yuyv, Nv12, Mjpeg };
+
+    /**
+     * @brief Full resolution pixels per pixel of the reduced luma.
+     */
+    static constexpr double scale{ 2.0 };
+
+    /**
+     * @brief Configures an opened camera to deliver undecoded frames.
+     *
+     * @param cap An opened video capture; it must outlive this object.
+     * @param format The pixel format to request.
+     * @throw std::runtime_error If the camera is not open.
+     */
+    LumaCapture(cv::VideoCapture& cap, StreamFormat format) : cap(cap), format(format) {
+        if (!cap.isOpened()) {
+            throw std::runtime_error("Cannot open camera.");
+        }
+        const int fourcc{ format == StreamFormat::Yuyv ? cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V')
+            : format == StreamFormat::Nv12 ? cv::VideoWriter::fourcc('N', 'V', '1', '2')
+            : cv::VideoWriter::fourcc('M', 'J', 'P', 'G') };
+        cap.set(cv::CAP_PROP_FOURCC, fourcc);
+        cap.set(cv::CAP_PROP_CONVERT_RGB, 0);
+    }
+
+    /**
+     * @brief Reads the next undecoded frame.
+     *
+     * @param rawFrame Set to the frame as delivered by the camera.
+     * @return false if no frame could be read.
+     */
+    bool read(cv::Mat& rawFrame) {
+        return cap.read(rawFrame);
+    }
+
+    /**
+     * @brief Decodes the luma of a frame at reduced scale, for detection.
+     *
+     * @param rawFrame A frame returned by read.
+     * @return Grayscale image 1 / scale the size of the frame.
+     */
+    cv::Mat decodeReducedLuma(const cv::Mat& rawFrame) const {
+        cv::Mat luma;
+        if (rawFrame.channels() == 3) {
+            cv::cvtColor(rawFrame, luma, cv::COLOR_BGR2GRAY);
+        }
+        else if (format == StreamFormat::Mjpeg) {
+            return cv::imdecode(rawFrame, cv::IMREAD_REDUCED_GRAYSCALE_2);
+        }
+        else if (format == StreamFormat::Yuyv) {
+            cv::extractChannel(rawFrame, luma, 0);
+        }
+        else {
+            luma = rawFrame.rowRange(0, rawFrame.rows * 2 / 3);
+        }
+        cv::Mat reducedLuma;
+        cv::resize(luma, reducedLuma, cv::Size(), 1.0 / scale, 1.0 / scale, cv::INTER_AREA);
+        return reducedLuma;
+    }
+
+    /**
+     * @brief Decodes a frame at full resolution around the tiles only.
+     *
+     * JPEG cannot be decoded by region, so MJPEG frames are decoded whole.
+     *
+     * @param rawFrame A frame returned by read.
+     * @param rotatedRectangles Location of the tiles at full resolution.
+     * @return BGR frame which is black away from the tiles.
+     */
+    cv::Mat decodeTiles(const cv::Mat& rawFrame, const std::vector<cv::RotatedRect>& rotatedRectangles) const {
+        if (rawFrame.channels() == 3) return rawFrame;
+        if (format == StreamFormat::Mjpeg) return cv::imdecode(rawFrame, cv::IMREAD_COLOR);
+
+        const cv::Size frameSize{ format == StreamFormat::Yuyv ? rawFrame.size() : cv::Size(rawFrame.cols, rawFrame.rows * 2 / 3) };
+        cv::Mat frame{ cv::Mat::zeros(frameSize, CV_8UC3) };
+        for (const cv::RotatedRect& rotatedRect : rotatedRectangles) {
+            const cv::Rect region{ evenRegion(rotatedRect.boundingRect(), frameSize) };
+            if (region.empty()) continue;
+            cv::Mat tileRegion{ frame(region) };
+            if (format == StreamFormat::Yuyv) {
+                cv::cvtColor(rawFrame(region), tileRegion, cv::COLOR_YUV2BGR_YUYV);
+            }
+            else {
+                // The interleaved chroma plane follows the luma plane at half resolution
+                cv::Mat chroma{ rawFrame.rowRange(frameSize.height, rawFrame.rows).reshape(2) };
+                const cv::Rect chromaRegion(region.x / 2, region.y / 2, region.width / 2, region.height / 2);
+                cv::cvtColorTwoPlane(rawFrame(region), chroma(chromaRegion), tileRegion, cv::COLOR_YUV2BGR_NV12);
+            }
+        }
+        return frame;
+    }
+
+private:
+    cv::VideoCapture& cap;
+    StreamFormat format;
+    static constexpr int tileRegionMargin{ 4 }; // pixels around each tile for interpolation
+
+    /**
+     * @brief Grows a region by the margin, clips it to the frame and aligns it to the chroma subsampling.
+     */
+    static cv::Rect evenRegion(const cv::Rect& region, const cv::Size& frameSize) {
+        int left{ std::max(0, region.x - tileRegionMargin) & ~1 };
+        int top{ std::max(0, region.y - tileRegionMargin) & ~1 };
+        int right{ std::min(frameSize.width, region.x + region.width + tileRegionMargin) & ~1 };
+        int bottom{ std::min(frameSize.height, region.y + region.height + tileRegionMargin) & ~1 };
+        if (right <= left || bottom <= top) return cv::Rect();
+        return cv::Rect(left, top, right - left, bottom - top);
+    }
+};
+
+#endif
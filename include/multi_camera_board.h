@@ -0,0 +1,284 @@
+/**
+ * @file multi_camera_board.h
+ * @brief Header file for the MultiCameraBoard class.
+ *
+ * This file contains the declaration of the MultiCameraBoard class, which
+ * recognizes the tiles seen by several cameras in parallel and combines them
+ * into a single board in the coordinates of the table.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef MULTI_CAMERA_BOARD_H
+#define MULTI_CAMERA_BOARD_H
+#include <cmath>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <opencv2/opencv.hpp>
+#include "letter_node.h"
+#include "letter_node_utils.h"
+#include "text_detector.h"
+#include "text_recognizer.h"
+#include "tile_pitch_estimator.h"
+
+/**
+ * @struct CameraCalibration
+ * @brief A camera and the homography from its pixels to table coordinates.
+ */
+struct CameraCalibration {
+    int index; // index to open the camera with
+    cv::Mat homography; // 3x3, camera pixels to table coordinates
+};
+
+/**
+ * @class MultiCameraBoard
+ * @brief Combines the tiles seen by several cameras into one board.
+ *
+ * Every camera has its own detector, recognizer and tile size estimate, since the
+ * tiles appear at a different scale in each, so the cameras are processed in
+ * parallel. The recognized tiles are mapped into table coordinates and tiles seen
+ * by more than one camera are kept once, from the camera which sees them largest.
+ */
+class MultiCameraBoard {
+public:
+    /**
+     * @brief Creates a detector and a recognizer for each camera.
+     *
+     * @param homographies For each camera, the 3x3 homography from its pixels to table coordinates.
+     * @throw std::invalid_argument If there are no cameras or a homography is not 3x3.
+     * @throw std::runtime_error If tesseract cannot be initialized.
+     */
+    explicit MultiCameraBoard(const std::vector<cv::Mat>& homographies) {
+        if (homographies.empty()) { throw std::invalid_argument("At least one camera is required."); }
+        for (const cv::Mat& homography : homographies) {
+            if (homography.rows != 3 || homography.cols != 3) { throw std::invalid_argument("Homographies must be 3x3."); }
+            cameras.push_back(std::make_unique<Camera>(homography));
+        }
+    }
+
+    /**
+     * @brief Sets how every camera's detector separates tiles from the table.
+     */
+    void setDetectionMode(TextDetector::DetectionMode mode) {
+        for (std::unique_ptr<Camera>& camera : cameras) camera->textDetector->setDetectionMode(mode);
+    }
+
+    /**
+     * @brief Sets how every camera's recognizer reads the letters of a word.
+     */
+    void setRecognitionMode(TextRecognizer::RecognitionMode mode) {
+        for (std::unique_ptr<Camera>& camera : cameras) camera->textRecognizer->setRecognitionMode(mode);
+    }
+
+    /**
+     * @brief Loads a tesseract model instead of eng into every camera's recognizer, in parallel.
+     *
+     * @param model The tesseract model to load from the tessdata directory.
+     * @throw std::runtime_error If tesseract cannot be initialized with the model.
+     */
+    void setModel(const std::string& model) {
+        forEachCamera([&model](Camera& camera, std::size_t) { camera.textRecognizer->loadModel(model); });
+    }
+
+    /**
+     * @brief Warms up every camera's recognizer in parallel, so the first frames are processed at full speed.
+     */
+    void warmUp() {
+        forEachCamera([](Camera& camera, std::size_t) { camera.textRecognizer->warmUp(); });
+    }
+
+    /**
+     * @brief Updates the model of the empty table of every camera, for the BackgroundModel detection mode.
+     *
+     * @param frames One frame from each camera, in the order of the homographies.
+     * @throw std::invalid_argument If there is not one frame per camera.
+     */
+    void updateBackground(const std::vector<cv::Mat>& frames) {
+        if (std::size(frames) != std::size(cameras)) { throw std::invalid_argument("Expected one frame per camera."); }
+        for (std::size_t i = 0; i < std::size(cameras); ++i) cameras[i]->textDetector->updateBackground(frames[i]);
+    }
+
+    /**
+     * @brief Reads the cameras and their homographies from a calibration file.
+     *
+     * The file is an OpenCV FileStorage file (YAML, JSON or XML) with a sequence
+     * "cameras" whose elements have an int "index" and a 3x3 matrix "homography".
+     *
+     * @param path Path to the calibration file.
+     * @return The calibration of each camera.
+     * @throw std::runtime_error If the file cannot be read or has no cameras.
+     */
+    static std::vector<CameraCalibration> loadCalibration(const std::string& path) {
+        cv::FileStorage file(path, cv::FileStorage::READ);
+        if (!file.isOpened()) { throw std::runtime_error("Cannot open calibration file " + path + "."); }
+        std::vector<CameraCalibration> calibrations{};
+        cv::FileNode cameraNodes{ file["cameras"] };
+        for (cv::FileNodeIterator it = cameraNodes.begin(); it != cameraNodes.end(); ++it) {
+            CameraCalibration calibration{};
+            (*it)["index"] >> calibration.index;
+            (*it)["homography"] >> calibration.homography;
+            calibration.homography.convertTo(calibration.homography, CV_64F);
+            calibrations.push_back(calibration);
+        }
+        if (calibrations.empty()) { throw std::runtime_error("No cameras in calibration file " + path + "."); }
+        return calibrations;
+    }
+
+    /**
+     * @brief Recognizes the tiles seen by all cameras.
+     *
+     * @param frames One frame from each camera, in the order of the homographies.
+     * @return A letter node for every tile on the table, in table coordinates.
+     * @throw std::invalid_argument If there is not one frame per camera.
+     */
+    std::vector<LetterNode> recognizeLetterNodes(const std::vector<cv::Mat>& frames) {
+        if (std::size(frames) != std::size(cameras)) { throw std::invalid_argument("Expected one frame per camera."); }
+
+        std::vector<std::vector<TableTile>> cameraTiles(std::size(cameras));
+        forEachCamera([&](Camera& camera, std::size_t i) { cameraTiles[i] = camera.recognize(frames[i]); });
+        return deduplicate(cameraTiles);
+    }
+
+    /**
+     * @brief Generates the words on the whole table.
+     *
+     * @param frames One frame from each camera, in the order of the homographies.
+     * @return Vector containing the words currently on the board.
+     */
+    std::vector<std::string> generateWords(const std::vector<cv::Mat>& frames) {
+        // Adjacency relative to the tile sizes does not depend on the units of the table coordinates
+        return TextRecognizer::connectLetterNodes(recognizeLetterNodes(frames));
+    }
+
+    /**
+     * @brief Maps a letter node from camera pixels to table coordinates.
+     *
+     * @param letterNode The letter node in camera pixels.
+     * @param homography The camera's homography.
+     * @return The letter node with the rectangle around its mapped corners.
+     */
+    static LetterNode toTable(const LetterNode& letterNode, const cv::Mat& homography) {
+        cv::Point2f corners[4];
+        letterNode.rect.points(corners);
+        std::vector<cv::Point2f> cameraPoints(corners, corners + 4);
+        std::vector<cv::Point2f> tablePoints{};
+        cv::perspectiveTransform(cameraPoints, tablePoints, homography);
+        return LetterNode{ letterNode.letter, cv::minAreaRect(tablePoints) };
+    }
+
+    /**
+     * @struct TableTile
+     * @brief A recognized tile in table coordinates and how large the camera saw it.
+     */
+    struct TableTile {
+        LetterNode letterNode;
+        float cameraArea; // area of the tile in camera pixels
+        std::size_t camera;
+    };
+
+    /**
+     * @brief Keeps each tile seen by more than one camera once.
+     *
+     * Tiles from different cameras whose centres are closer than half a tile are the
+     * same tile; the one with the most camera pixels is kept.
+     *
+     * @param cameraTiles The tiles recognized by each camera.
+     * @return The tiles on the table.
+     */
+    static std::vector<LetterNode> deduplicate(const std::vector<std::vector<TableTile>>& cameraTiles) {
+        std::vector<TableTile> tiles{};
+        for (std::size_t camera = 0; camera < std::size(cameraTiles); ++camera) {
+            for (TableTile tile : cameraTiles[camera]) {
+                tile.camera = camera;
+                tiles.push_back(tile);
+            }
+        }
+        if (tiles.empty()) return {};
+
+        // Median tile side length in table coordinates
+        std::vector<float> sides{};
+        for (const TableTile& tile : tiles) sides.push_back(std::sqrt(tile.letterNode.rect.size.area()));
+        std::nth_element(sides.begin(), sides.begin() + std::size(sides) / 2, sides.end());
+        const float duplicateDistance{ duplicateInTileSizes * sides[std::size(sides) / 2] };
+
+        std::stable_sort(tiles.begin(), tiles.end(), [](const TableTile& a, const TableTile& b) { return a.cameraArea > b.cameraArea; });
+        std::vector<const TableTile*> kept{};
+        for (const TableTile& tile : tiles) {
+            bool duplicate{ false };
+            for (const TableTile* other : kept) {
+                if (other->camera != tile.camera && cv::norm(other->letterNode.rect.center - tile.letterNode.rect.center) < duplicateDistance) {
+                    duplicate = true;
+                    break;
+                }
+            }
+            if (!duplicate) kept.push_back(&tile);
+        }
+
+        std::vector<LetterNode> letterNodes{};
+        for (const TableTile* tile : kept) letterNodes.push_back(tile->letterNode);
+        return letterNodes;
+    }
+
+private:
+
+    /**
+     * @struct Camera
+     * @brief The detection and recognition state of one camera.
+     */
+    struct Camera {
+        cv::Mat homography;
+        TilePitchEstimator tilePitchEstimator{};
+        std::unique_ptr<TextDetector> textDetector;
+        std::unique_ptr<TextRecognizer> textRecognizer;
+
+        explicit Camera(const cv::Mat& homography)
+            : homography(homography.clone()),
+            textDetector(TextDetector::createInstance(tilePitchEstimator)),
+            textRecognizer(TextRecognizer::createInstance(tilePitchEstimator)) {}
+
+        std::vector<TableTile> recognize(const cv::Mat& frame) {
+            std::vector<cv::RotatedRect> tileLocations{ textDetector->getTileLocations(frame, false) };
+            std::vector<TableTile> tiles{};
+            for (const LetterNode& letterNode : textRecognizer->recognizeLetterNodes(frame, tileLocations, false)) {
+                tiles.push_back(TableTile{ toTable(letterNode, homography), letterNode.rect.size.area(), 0 });
+            }
+            return tiles;
+        }
+    };
+
+    std::vector<std::unique_ptr<Camera>> cameras{};
+    static constexpr float duplicateInTileSizes{ 0.5f };
+
+    /**
+     * @brief Runs a function on every camera, each on its own thread.
+     *
+     * @param function Called with the camera and its index.
+     * @throw The first exception thrown by the function, once every thread has finished.
+     */
+    template <typename Function>
+    void forEachCamera(Function function) {
+        std::vector<std::exception_ptr> errors(std::size(cameras));
+        std::vector<std::thread> threads{};
+        for (std::size_t i = 0; i < std::size(cameras); ++i) {
+            threads.emplace_back([&, i]() {
+                try {
+                    function(*cameras[i], i);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            });
+        }
+        std::for_each(threads.begin(), threads.end(), [](std::thread& thread) { thread.join(); });
+        for (const std::exception_ptr& error : errors) {
+            if (error) std::rethrow_exception(error);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file pool_tracker.h
+ * @brief Header file for the PoolTracker class.
+ *
+ * Contains the declaration of the PoolTracker class, which incrementally
+ * tracks which dictionary words can be formed from the face-up tiles in
+ * the pool as tiles are flipped and taken. The application does not feed
+ * it yet, since the detector cannot tell a newly flipped pool tile from a
+ * single letter word, so flips and takes are reported by the caller.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef POOL_TRACKER_H
+#define POOL_TRACKER_H
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+#include "anagram_index.h"
+
+/**
+ * @class PoolTracker
+ * @brief Keeps, for every anagram class, how many letters the pool still lacks.
+ *
+ * A letter to classes inverted index, bucketed by how many copies of the letter
+ * each class needs, means a flip only touches the classes which needed one more
+ * copy of the flipped letter. Words become formable exactly when their deficit
+ * reaches zero, so no combinations of tiles are ever enumerated.
+ */
+class PoolTracker {
+public:
+    /**
+     * @brief Creates a tracker for an empty pool.
+     *
+     * @param anagramIndex The dictionary; it must outlive the tracker.
+     * @param lexicons Only classes with a word in one of these word lists are tracked.
+     */
+    explicit PoolTracker(const AnagramIndex& anagramIndex, LexiconMask lexicons = AnagramIndex::allLexicons)
+        : anagramIndex(anagramIndex), lexicons(lexicons) {
+        const std::vector<AnagramClass>& classes = anagramIndex.getClasses();
+        deficits.assign(std::size(classes), 0);
+        for (std::size_t i = 0; i < std::size(classes); ++i) {
+            if (!(classes[i].lexiconMask & lexicons)) { continue; }
+            deficits[i] = static_cast<std::uint8_t>(std::size(classes[i].sortedWord));
+            for (std::size_t letter = 0; letter < 26; ++letter) {
+                const std::uint8_t need{ classes[i].counts[letter] };
+                if (need == 0) { continue; }
+                if (std::size(classesByNeed[letter]) <= need) { classesByNeed[letter].resize(need + 1); }
+                classesByNeed[letter][need].push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+    }
+
+    /**
+     * @brief Adds a face-up tile to the pool.
+     *
+     * @param letter The letter on the tile.
+     * @return Indices into the index's classes which have just become formable.
+     * @throw std::invalid_argument If the letter is not A-Z.
+     */
+    std::vector<std::size_t> flipTile(char letter) {
+        const std::size_t l{ letterIndex(letter) };
+        const std::size_t have{ ++pool[l] };
+        std::vector<std::size_t> formable{};
+        // Only classes needing at least this many copies were short of this one
+        for (std::size_t need = have; need < std::size(classesByNeed[l]); ++need) {
+            for (std::uint32_t i : classesByNeed[l][need]) {
+                if (--deficits[i] == 0) { formable.push_back(i); }
+            }
+        }
+        return formable;
+    }
+
+    /**
+     * @brief Removes a tile from the pool, e.g. because it was used in a word.
+     *
+     * @param letter The letter on the tile.
+     * @return Indices into the index's classes which are no longer formable.
+     * @throw std::invalid_argument If the letter is not A-Z or is not in the pool.
+     */
+    std::vector<std::size_t> removeTile(char letter) {
+        const std::size_t l{ letterIndex(letter) };
+        if (pool[l] == 0) { throw std::invalid_argument("Tile is not in the pool."); }
+        const std::size_t had{ pool[l]-- };
+        std::vector<std::size_t> unformable{};
+        for (std::size_t need = had; need < std::size(classesByNeed[l]); ++need) {
+            for (std::uint32_t i : classesByNeed[l][need]) {
+                if (deficits[i]++ == 0) { unformable.push_back(i); }
+            }
+        }
+        return unformable;
+    }
+
+    /**
+     * @brief Lists the words of a class which belong to the tracked word lists.
+     *
+     * @param classIndex Index into the index's classes.
+     * @return The words of the class.
+     */
+    std::vector<std::string> getWords(std::size_t classIndex) const {
+        const AnagramClass& anagramClass = anagramIndex.getClasses()[classIndex];
+        std::vector<std::string> words{};
+        for (std::size_t i = 0; i < std::size(anagramClass.anagrams); ++i) {
+            if (anagramClass.lexicons[i] & lexicons) { words.push_back(anagramClass.anagrams[i]); }
+        }
+        return words;
+    }
+
+    /**
+     * @param classIndex Index into the index's classes.
+     * @return Number of letters the pool lacks to form the class.
+     */
+    std::size_t getDeficit(std::size_t classIndex) const {
+        return deficits[classIndex];
+    }
+
+    /**
+     * @return The letters currently in the pool.
+     */
+    const LetterCounts& getPool() const {
+        return pool;
+    }
+
+private:
+    const AnagramIndex& anagramIndex;
+    LexiconMask lexicons;
+    LetterCounts pool{};
+    std::vector<std::uint8_t> deficits; // 0 for formable classes and for classes not tracked
+    std::array<std::vector<std::vector<std::uint32_t>>, 26> classesByNeed{}; // [letter][copies needed]
+
+    /**
+     * @brief Converts a tile letter to an index into the count arrays.
+     */
+    static std::size_t letterIndex(char letter) {
+        if (letter < 'A' || letter > 'Z') { throw std::invalid_argument("Tile letter must be A-Z."); }
+        return static_cast<std::size_t>(letter - 'A');
+    }
+};
+
+#endif
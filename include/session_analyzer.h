@@ -0,0 +1,139 @@
+/**
+ * @file session_analyzer.h
+ * @brief Header file for the offline analysis of recorded games.
+ *
+ * This file contains functions which replay a sequence of recognised boards
+ * and report, for every play which became available, when it appeared and
+ * how long it went unclaimed.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef SESSION_ANALYZER_H
+#define SESSION_ANALYZER_H
+#include <atomic>
+#include <thread>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include "snatchable_word_generator.h"
+
+/**
+ * @struct BoardObservation
+ * @brief The words recognised on the board at a point in time.
+ */
+struct BoardObservation {
+    double timestamp; // seconds since the start of the recording
+    std::vector<std::string> words;
+};
+
+/**
+ * @struct AvailabilityWindow
+ * @brief A period during which a play could have been made.
+ *
+ * The window opens at the first observation where the play is available and
+ * closes at the first observation where it no longer is, or at the last
+ * observation if it was never claimed.
+ */
+struct AvailabilityWindow {
+    std::string word;
+    double start;
+    double end;
+
+    bool operator==(const AvailabilityWindow& other) const = default;
+};
+
+namespace SessionAnalyzer {
+    /**
+     * @brief Builds a key which is identical for boards holding the same words.
+     *
+     * @param words The words on the board, in any order.
+     * @return The sorted words joined by newlines.
+     */
+    inline std::string canonicalBoardKey(std::vector<std::string> words) {
+        std::sort(words.begin(), words.end());
+        std::string key;
+        for (const std::string& word : words) {
+            key += word;
+            key += '\n';
+        }
+        return key;
+    }
+
+    /**
+     * @brief Finds when every play in a recorded game was available.
+     *
+     * Observations with the same words are solved once, and the distinct boards
+     * are solved in parallel since long sessions mostly repeat a few states.
+     *
+     * @param observations The recognised boards, ordered by timestamp.
+     * @param restrictions Restrictions applied to every board; its words are ignored.
+     * @param numThreads Number of solver threads, 0 for one per core.
+     * @return The availability windows ordered by start time, then by word.
+     */
+    inline std::vector<AvailabilityWindow> findAvailabilityWindows(const std::vector<BoardObservation>& observations,
+        const SnatchQuery& restrictions = SnatchQuery{}, unsigned int numThreads = 0) {
+        // Deduplicate identical boards
+        std::unordered_map<std::string, std::size_t> keyToState{};
+        std::vector<const BoardObservation*> states{};
+        std::vector<std::size_t> observationStates{};
+        observationStates.reserve(std::size(observations));
+        for (const BoardObservation& observation : observations) {
+            auto [it, inserted] = keyToState.try_emplace(canonicalBoardKey(observation.words), std::size(states));
+            if (inserted) { states.push_back(&observation); }
+            observationStates.push_back(it->second);
+        }
+
+        // Solve the distinct boards in parallel
+        std::vector<std::vector<std::string>> statePlays(std::size(states));
+        std::atomic<std::size_t> nextState{ 0 };
+        auto solve = [&]() {
+            const SnatchableWordGenerator& snatchableWordGenerator = SnatchableWordGenerator::getInstance();
+            for (std::size_t i = nextState++; i < std::size(states); i = nextState++) {
+                SnatchQuery query{ restrictions };
+                query.words = states[i]->words;
+                statePlays[i] = snatchableWordGenerator.generateSnatchableWords(query);
+            }
+        };
+        if (numThreads == 0) { numThreads = std::max(1u, std::thread::hardware_concurrency()); }
+        numThreads = static_cast<unsigned int>(std::min<std::size_t>(numThreads, std::size(states)));
+        SnatchableWordGenerator::getInstance(); // load the dictionary before starting the threads
+        std::vector<std::thread> threads{};
+        for (unsigned int i = 1; i < numThreads; ++i) { threads.emplace_back(solve); }
+        solve();
+        std::for_each(threads.begin(), threads.end(), [](std::thread& thread) { thread.join(); });
+
+        // Sweep through the observations opening and closing windows
+        std::vector<AvailabilityWindow> windows{};
+        std::unordered_map<std::string, double> open{};
+        for (std::size_t i = 0; i < std::size(observations); ++i) {
+            const double timestamp{ observations[i].timestamp };
+            const std::vector<std::string>& plays = statePlays[observationStates[i]];
+            std::unordered_set<std::string> available(plays.begin(), plays.end());
+            for (auto it = open.begin(); it != open.end();) {
+                if (available.contains(it->first)) {
+                    ++it;
+                }
+                else {
+                    windows.push_back(AvailabilityWindow{ it->first, it->second, timestamp });
+                    it = open.erase(it);
+                }
+            }
+            for (const std::string& play : plays) {
+                open.try_emplace(play, timestamp);
+            }
+        }
+        const double lastTimestamp{ observations.empty() ? 0.0 : observations.back().timestamp };
+        for (const auto& [word, start] : open) {
+            windows.push_back(AvailabilityWindow{ word, start, lastTimestamp });
+        }
+        std::sort(windows.begin(), windows.end(), [](const AvailabilityWindow& a, const AvailabilityWindow& b) {
+            return a.start == b.start ? a.word < b.word : a.start < b.start;
+        });
+        return windows;
+    }
+}
+
+#endif
@@ -13,8 +13,91 @@
 #define SNATCHABLE_WORD_GENERATOR_H
 #include <vector>
 #include <string>
+#include <span>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
 #include <fstream>
 #include <algorithm>
+#include <unordered_set>
+#include <limits>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <memory_resource>
+#include "anagram_index.h"
+#include "lexicon_overlay.h"
+
+/**
+ * @brief Word lists loaded by the SnatchableWordGenerator, as LexiconMask bits.
+ */
+namespace Lexicon {
+	constexpr LexiconMask Popular{ 1 << 0 }; // words_popular.txt, for casual games
+	constexpr LexiconMask Ospd{ 1 << 1 }; // words_ospd.txt
+	constexpr LexiconMask Collins{ 1 << 2 }; // words_collins_scrabble_2019.txt, for tournaments
+	constexpr LexiconMask All{ Popular | Ospd | Collins };
+}
+
+/**
+ * @struct SnatchQuery
+ * @brief The words on the board together with restrictions on the plays wanted.
+ *
+ * The restrictions are applied while searching, so a more restrictive query
+ * is cheaper to answer. Single letter words are treated as tiles in the pool.
+ */
+struct SnatchQuery {
+	std::vector<std::string> words;
+	std::size_t minResultLength{ 3 };
+	std::size_t maxResultLength{ std::numeric_limits<std::size_t>::max() };
+	std::size_t maxSourceWords{ std::numeric_limits<std::size_t>::max() };
+	bool requirePoolTile{ false };
+	std::vector<std::size_t> requiredWords{}; // indices into words, at least one must be used
+	LexiconMask lexicons{ Lexicon::Popular }; // word lists the result may come from
+};
+
+/**
+ * @struct BasicSnatchablePlay
+ * @brief A snatchable word and the word lists, out of those queried, containing it.
+ */
+template <typename String>
+struct BasicSnatchablePlay {
+	String word;
+	LexiconMask lexicons;
+
+	bool operator==(const BasicSnatchablePlay& other) const = default;
+};
+
+using SnatchablePlay = BasicSnatchablePlay<std::string>;
+
+/**
+ * @brief A snatchable play whose word is allocated from a memory resource, e.g. a FrameArena.
+ */
+using PmrSnatchablePlay = BasicSnatchablePlay<std::pmr::string>;
+
+/**
+ * @struct LetterCandidate
+ * @brief One possible reading of an ambiguous tile.
+ */
+struct LetterCandidate {
+	char letter;
+	double probability;
+};
+
+/**
+ * @brief A word on the board where each tile has one or more candidate letters.
+ */
+using UncertainWord = std::vector<std::vector<LetterCandidate>>;
+
+/**
+ * @struct ProbableSnatchablePlay
+ * @brief A snatchable word along with the probability that it can really be played.
+ */
+struct ProbableSnatchablePlay {
+	std::string word;
+	LexiconMask lexicons;
+	double probability;
+};
 
 /**
  * @class SnatchableWordGenerator
@@ -33,95 +116,743 @@ public:
 	SnatchableWordGenerator(const SnatchableWordGenerator&) = delete;
 	SnatchableWordGenerator& operator=(const SnatchableWordGenerator&) = delete;
 
+	/**
+	 * @brief Strategy used to search for snatchable words.
+	 *
+	 * SubsetDriven enumerates every combination of words on the board, which costs 2^n
+	 * in the number of words. DictionaryDriven instead walks the anagram classes of the
+	 * dictionary and solves a multi-dimensional subset-sum problem for each one, which is
+	 * cheaper once the board is large. Automatic picks whichever should be faster.
+	 */
+	enum class SolveMode { Automatic, SubsetDriven, DictionaryDriven };
+
 	/*
 	 * @brief Generates a list of snatchable words from the words currently on the board.
 	 * 
 	 * Snatchable words are formed from at least two other words on the board.
 	 * Each word is a group of >= 1 letters. Valid snatchable words must be at least three
-	 * letters in length .This is guaranteed since sortedStringToAnagrams has been made to
+	 * letters in length .This is guaranteed since the anagram index has been made to
 	 * only contain strings which are greater than three characters in length.
 	 * 
 	 * @param words List of words currently on the board.
+	 * @param mode Search strategy; Automatic chooses based on the board size.
 	 * @return A list of snatchable words ordered by size and then alphabetically.
 	 */
-	std::vector<std::string> generateSnatchableWords(const std::vector<std::string>& words) {
+	std::vector<std::string> generateSnatchableWords(const std::vector<std::string>& words, SolveMode mode = SolveMode::Automatic) const {
+		return generateSnatchableWords(SnatchQuery{ words }, mode);
+	}
+
+	/*
+	 * @brief Generates the snatchable words satisfying the restrictions of a query.
+	 *
+	 * The restrictions prune the search rather than filtering its results.
+	 *
+	 * @param query The words on the board and the restrictions on the plays.
+	 * @param mode Search strategy; Automatic chooses based on the board size.
+	 * @param resource Memory resource for the search's transient data, e.g. a FrameArena.
+	 * @return A list of snatchable words ordered by size and then alphabetically.
+	 */
+	std::vector<std::string> generateSnatchableWords(const SnatchQuery& query, SolveMode mode = SolveMode::Automatic,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const {
+		std::vector<SnatchablePlay> plays{ generateSnatchablePlays(query, mode, resource) };
 		std::vector<std::string> snatchableWords{};
-		std::vector<std::vector<std::string>> powerSetWords{ generateSubsets(std::size(words)-1, words)};
-		// Snatchable words are formed from at least two other words on the board
-		std::erase_if(powerSetWords, [](const std::vector<std::string>& subset) { return subset.size() <= 1; });
-
-		for (const std::vector<std::string>& subset: powerSetWords) {
-			// Join all strings in the subset into one sorted string
-			std::string combinedString;
-			std::for_each(subset.begin(), subset.end(), [&combinedString](const std::string& word) { combinedString += word; });
-			std::sort(combinedString.begin(), combinedString.end());
-
-			if (sortedStringToAnagrams.contains(combinedString)) {
-				std::vector<std::string> anagrams{ sortedStringToAnagrams.at(combinedString) };
-				std::for_each(anagrams.begin(), anagrams.end(), [&snatchableWords](std::string a) { snatchableWords.push_back(a); });
+		snatchableWords.reserve(std::size(plays));
+		std::for_each(plays.begin(), plays.end(), [&snatchableWords](SnatchablePlay& play) { snatchableWords.push_back(std::move(play.word)); });
+		return snatchableWords;
+	}
+
+	/*
+	 * @brief Generates the snatchable plays of a query along with their word lists.
+	 *
+	 * A single search answers the query for every word list in query.lexicons, e.g.
+	 * Lexicon::Ospd | Lexicon::Collins to show casual and tournament plays together.
+	 *
+	 * @param query The words on the board and the restrictions on the plays.
+	 * @param mode Search strategy; Automatic chooses based on the board size.
+	 * @param resource Memory resource for the search's transient data, e.g. a FrameArena.
+	 * @return A list of snatchable plays ordered by size and then alphabetically.
+	 */
+	std::vector<SnatchablePlay> generateSnatchablePlays(const SnatchQuery& query, SolveMode mode = SolveMode::Automatic,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource()) const {
+		std::vector<SnatchablePlay> plays{};
+		solve(std::span<const std::string>(query.words), query, mode, resource, plays);
+		return plays;
+	}
+
+	/*
+	 * @brief Generates the snatchable plays of words allocated from a memory resource, allocating the plays from it too.
+	 *
+	 * Nothing is copied to the heap, so a board recognized into a FrameArena can be
+	 * solved within the arena.
+	 *
+	 * @param words The words on the board.
+	 * @param restrictions The restrictions on the plays; restrictions.words is ignored and
+	 *        restrictions.requiredWords are indices into words.
+	 * @param mode Search strategy; Automatic chooses based on the board size.
+	 * @param resource Memory resource for the plays and the search's transient data.
+	 * @return A list of snatchable plays ordered by size and then alphabetically.
+	 */
+	std::pmr::vector<PmrSnatchablePlay> generateSnatchablePlays(std::span<const std::pmr::string> words, const SnatchQuery& restrictions, SolveMode mode,
+		std::pmr::memory_resource* resource) const {
+		std::pmr::vector<PmrSnatchablePlay> plays{ resource };
+		solve(words, restrictions, mode, resource, plays);
+		return plays;
+	}
+
+	/*
+	 * @brief Generates the snatchable words of words allocated from a memory resource, allocating the result from it too.
+	 *
+	 * @param words The words on the board.
+	 * @param restrictions The restrictions on the plays; restrictions.words is ignored and
+	 *        restrictions.requiredWords are indices into words.
+	 * @param mode Search strategy; Automatic chooses based on the board size.
+	 * @param resource Memory resource for the result and the search's transient data, e.g. a FrameArena.
+	 * @return A list of snatchable words ordered by size and then alphabetically.
+	 */
+	std::pmr::vector<std::pmr::string> generateSnatchableWords(std::span<const std::pmr::string> words, const SnatchQuery& restrictions, SolveMode mode,
+		std::pmr::memory_resource* resource) const {
+		std::pmr::vector<PmrSnatchablePlay> plays{ generateSnatchablePlays(words, restrictions, mode, resource) };
+		std::pmr::vector<std::pmr::string> snatchableWords{ resource };
+		snatchableWords.reserve(std::size(plays));
+		std::for_each(plays.begin(), plays.end(), [&snatchableWords](PmrSnatchablePlay& play) { snatchableWords.push_back(std::move(play.word)); });
+		return snatchableWords;
+	}
+
+	/**
+	 * @brief Generates every dictionary word which can be formed from a set of letters.
+	 *
+	 * Unlike generateSnatchableWords the letters do not have to be used up, which makes
+	 * this suitable for finding plays made purely from tiles in the pool.
+	 *
+	 * @param letters The available letters, e.g. the face-up tiles in the pool.
+	 * @param lexicons The word lists the words may come from.
+	 * @return A list of formable words ordered by size and then alphabetically.
+	 */
+	std::vector<std::string> generateFormableWords(const std::string& letters, LexiconMask lexicons = Lexicon::Popular) const {
+		std::vector<std::string> formableWords{};
+		LetterCounts counts{};
+		for (char c : letters) {
+			// ignore unrecognised tiles
+			if (c >= 'A' && c <= 'Z') { ++counts[c - 'A']; }
+		}
+		std::shared_ptr<const LexiconOverlay> overlay{ houseRules.load() };
+		std::vector<SnatchablePlay> plays{};
+		for (std::size_t classIndex : anagramIndex.findFittingClasses(counts, 0, lexicons)) {
+			addPlays(&anagramIndex.getClasses()[classIndex], lexicons, overlay.get(), plays);
+		}
+		if (overlay) {
+			for (const AnagramClass& addedClass : overlay->getAddedClasses()) {
+				if (AnagramIndex::fitsWithin(addedClass.counts, counts)) {
+					addAddedPlays(addedClass, lexicons, *overlay, plays);
+				}
 			}
+		}
+		std::for_each(plays.begin(), plays.end(), [&formableWords](SnatchablePlay& play) { formableWords.push_back(std::move(play.word)); });
+		std::sort(formableWords.begin(), formableWords.end(), [](const std::string& a, const std::string& b) { return a.size() == b.size() ? a < b : b.size() < a.size(); });
+		return formableWords;
+	}
 
+	/**
+	 * @brief Generates snatchable plays from words whose tiles have uncertain letters.
+	 *
+	 * Each tile lists its candidate letters with their probabilities, e.g. an O which
+	 * might be a Q. The letters each combination of words could spell are built up one
+	 * word at a time, so combinations sharing a prefix share its letter distribution, and
+	 * branches less likely than minProbability are dropped.
+	 *
+	 * The probability of a play is that of the likeliest single combination of words
+	 * forming it; tiles are treated as independent.
+	 *
+	 * @param words The words on the board with candidate letters for each tile.
+	 * @param lexicons The word lists the plays may come from.
+	 * @param minProbability Plays and partial combinations below this are discarded.
+	 * @return Snatchable plays ordered by probability, then by size and alphabetically.
+	 */
+	std::vector<ProbableSnatchablePlay> generateProbableSnatchablePlays(const std::vector<UncertainWord>& words,
+		LexiconMask lexicons = Lexicon::Popular, double minProbability = 0.01) const {
+		std::vector<std::vector<Reading>> readings{};
+		for (const UncertainWord& word : words) {
+			std::vector<Reading> wordReadings{ generateReadings(word, minProbability) };
+			if (!wordReadings.empty()) { readings.push_back(std::move(wordReadings)); }
 		}
-		// Order by size and then alphabetically
-		std::sort(snatchableWords.begin(), snatchableWords.end(), [](const std::string& a, const std::string& b) { return a.size() == b.size() ? a < b : b.size() < a.size(); });
-		return snatchableWords;
+		std::shared_ptr<const LexiconOverlay> overlay{ houseRules.load() };
+		std::unordered_map<std::string, ProbableSnatchablePlay> bestPlays{};
+		enumerateReadings(readings, 0, std::vector<Reading>{ Reading{ LetterCounts{}, 1.0 } }, 0, lexicons, minProbability, overlay.get(), bestPlays);
+
+		std::vector<ProbableSnatchablePlay> plays{};
+		for (auto& [word, play] : bestPlays) {
+			if (play.probability >= minProbability) { plays.push_back(std::move(play)); }
+		}
+		std::sort(plays.begin(), plays.end(), [](const ProbableSnatchablePlay& a, const ProbableSnatchablePlay& b) {
+			if (a.probability != b.probability) { return a.probability > b.probability; }
+			return a.word.size() == b.word.size() ? a.word < b.word : b.word.size() < a.word.size();
+		});
+		return plays;
+	}
+
+	/**
+	 * @return The dictionary, e.g. for building a PoolTracker.
+	 */
+	const AnagramIndex& getAnagramIndex() const {
+		return anagramIndex;
+	}
+
+	/**
+	 * @brief Accepts a word under the house rules, without rebuilding the dictionary.
+	 *
+	 * @param word The word to accept, e.g. a proper noun the table allows.
+	 * @param lexicons The word lists the word is treated as belonging to.
+	 * @return false if the word could never be snatched.
+	 */
+	bool allowHouseWord(const std::string& word, LexiconMask lexicons = Lexicon::All) {
+		return editHouseRules([&](LexiconOverlay& overlay) { return overlay.allowWord(word, lexicons); });
+	}
+
+	/**
+	 * @brief Bans a word under the house rules, without rebuilding the dictionary.
+	 *
+	 * @param word The word to ban from every word list.
+	 * @return false if the word could never be snatched anyway.
+	 */
+	bool banHouseWord(const std::string& word) {
+		return editHouseRules([&](LexiconOverlay& overlay) { return overlay.banWord(word); });
+	}
+
+	/**
+	 * @brief Removes all house rules.
+	 */
+	void clearHouseRules() {
+		std::lock_guard<std::mutex> lock{ houseRulesMutex };
+		houseRules.store(nullptr);
 	}
 
 private:
 	/**
 	 * @brief Private constructor to prevent instantiation.
 	 * 
-	 * @param dictionaryPath Path to the dictionary file.
+	 * The word lists are merged into a single index, the ith path providing bit i of
+	 * each word's LexiconMask, in the order of the Lexicon constants.
+	 *
+	 * @param dictionaryPaths Paths to the dictionary files.
 	 * @throw std::runtime_error If cannot initialize.
 	 */
-    SnatchableWordGenerator(const char* dictionaryPath = "words_popular.txt") {
-        std::ifstream infile(dictionaryPath);
-		std::string word;
-		if (infile.is_open()) {
-			while (std::getline(infile, word)) {
-				// snatchable words must be at least length three
-				if (std::size(word) < 3) { continue; }
-				std::transform(word.begin(), word.end(), word.begin(), [](char c) { return std::toupper(c); });
-				std::string sortedWord = word;
-				std::sort(sortedWord.begin(), sortedWord.end());
-				sortedStringToAnagrams[sortedWord].push_back(word);
+    SnatchableWordGenerator(const std::vector<std::string>& dictionaryPaths = { "words_popular.txt", "words_ospd.txt", "words_collins_scrabble_2019.txt" }) {
+		std::vector<std::ifstream> infiles{};
+		std::vector<std::istream*> lexicons{};
+		infiles.reserve(std::size(dictionaryPaths));
+		for (const std::string& dictionaryPath : dictionaryPaths) {
+			std::ifstream& infile = infiles.emplace_back(dictionaryPath);
+			if (!infile.is_open()) {
+				throw std::runtime_error("Cannot open dictionary file " + dictionaryPath + ".");
 			}
-			infile.close();
-		}
-		else {
-			throw std::runtime_error("Cannot open dictionary file.");
+			lexicons.push_back(&infile);
 		}
+		anagramIndex = AnagramIndex(lexicons);
     }
 
-    std::unordered_map<std::string, std::vector<std::string>> sortedStringToAnagrams;
+    AnagramIndex anagramIndex;
+	// House rules are copied on write and published atomically, so queries never wait on edits
+	// and pay for nothing but a null check while there are none.
+	std::atomic<std::shared_ptr<const LexiconOverlay>> houseRules{};
+	std::mutex houseRulesMutex;
 
 	/**
-	 * @brief Generate all subsets of words up to and including the ith word.
-	 * 
-	 * @param i An index corresponding to the words array to generate subsets for.
-	 * @return All subsets of the words array up to and including the ith index.
+	 * @brief Applies an edit to a copy of the house rules and publishes the result.
+	 *
+	 * @param edit Modifies the overlay and returns whether it changed.
+	 * @return The result of edit.
 	 */
-	std::vector<std::vector<std::string>> generateSubsets(int i, const std::vector<std::string>& words) {
-		std::vector<std::vector<std::string>> result{};
-		if (i < 0) {
-			return result;
+	template <typename Edit>
+	bool editHouseRules(Edit edit) {
+		std::lock_guard<std::mutex> lock{ houseRulesMutex };
+		std::shared_ptr<const LexiconOverlay> current{ houseRules.load() };
+		auto next = current ? std::make_shared<LexiconOverlay>(*current) : std::make_shared<LexiconOverlay>();
+		if (!edit(*next)) { return false; }
+		houseRules.store(next->empty() ? nullptr : std::shared_ptr<const LexiconOverlay>(std::move(next)));
+		return true;
+	}
+
+	/**
+	 * @brief Picks the cheaper search strategy for a board.
+	 *
+	 * The subset-driven search visits 2^n combinations whereas the dictionary-driven
+	 * search visits every anagram class once, so switch over when the former is larger.
+	 *
+	 * @param numWords Number of words on the board.
+	 * @return Either SubsetDriven or DictionaryDriven.
+	 */
+	SolveMode chooseSolveMode(std::size_t numWords) const {
+		constexpr std::size_t maxSubsetDrivenWords{ 32 };
+		if (numWords < maxSubsetDrivenWords && (std::size_t{ 1 } << numWords) <= std::size(anagramIndex.getClasses())) {
+			return SolveMode::SubsetDriven;
 		}
-		else if (i == 0) {
-			result.push_back({});
-			result.push_back({words[0]});
-			return result;
+		return SolveMode::DictionaryDriven;
+	}
+
+	/**
+	 * @brief Answers a query, appending its plays ordered by size and then alphabetically.
+	 *
+	 * @param words The words on the board.
+	 * @param restrictions The restrictions on the plays; restrictions.words is ignored.
+	 * @param mode Search strategy; Automatic chooses based on the board size.
+	 * @param resource Memory resource for the search's transient data.
+	 * @param plays An empty list receiving the snatchable plays.
+	 */
+	template <typename String, typename Plays>
+	void solve(std::span<const String> words, const SnatchQuery& restrictions, SolveMode mode, std::pmr::memory_resource* resource, Plays& plays) const {
+		if (mode == SolveMode::Automatic) {
+			mode = chooseSolveMode(std::size(words));
+		}
+		std::shared_ptr<const LexiconOverlay> overlay{ houseRules.load() };
+		Board board{ words, restrictions, overlay.get(), resource };
+		if (mode == SolveMode::DictionaryDriven) {
+			generateDictionaryDriven(board, plays);
 		}
 		else {
-			std::vector<std::vector<std::string>> subproblem = generateSubsets(i-1, words);
-			for (const std::vector<std::string>& subset : subproblem) {
-				result.push_back(subset);
-				std::vector<std::string> newSubset(subset.begin(), subset.end());
-				newSubset.push_back(words[i]);
-				result.push_back(newSubset);
+			generateSubsetDriven(board, plays);
+		}
+		// Order by size and then alphabetically
+		std::sort(plays.begin(), plays.end(), [](const auto& a, const auto& b) { return a.word.size() == b.word.size() ? a.word < b.word : b.word.size() < a.word.size(); });
+	}
+
+	/**
+	 * @brief Appends a play, allocating its word like the list.
+	 */
+	template <typename Plays>
+	static void addPlay(Plays& plays, const std::string& word, LexiconMask lexicons) {
+		using Play = typename Plays::value_type;
+		using String = decltype(Play::word);
+		plays.push_back(Play{ String(word, typename String::allocator_type(plays.get_allocator())), lexicons });
+	}
+
+	/**
+	 * @struct Board
+	 * @brief The words of a query prepared for searching.
+	 *
+	 * Words are ordered longest first so that dead ends are found early, and suffix
+	 * totals record what words[i..] can still contribute so branches can be pruned.
+	 */
+	struct Board {
+		struct Component {
+			LetterCounts counts{};
+			std::size_t length{ 0 };
+			bool isPoolTile{ false };
+			bool isRequired{ false };
+		};
+
+		std::pmr::vector<Component> components;
+		std::pmr::vector<LetterCounts> suffixTotals; // letters in components[i..]
+		std::pmr::vector<std::size_t> suffixLengths;
+		std::pmr::vector<std::size_t> suffixPoolTiles;
+		std::pmr::vector<std::size_t> suffixRequired;
+		std::size_t minResultLength;
+		std::size_t maxResultLength;
+		std::size_t maxSourceWords;
+		bool requirePoolTile;
+		bool requireWord;
+		LexiconMask lexicons;
+		const LexiconOverlay* overlay; // house rules, nullptr if there are none
+
+		template <typename String>
+		Board(std::span<const String> words, const SnatchQuery& query, const LexiconOverlay* houseRules, std::pmr::memory_resource* resource)
+			: components(resource),
+			suffixTotals(resource),
+			suffixLengths(resource),
+			suffixPoolTiles(resource),
+			suffixRequired(resource),
+			minResultLength(query.minResultLength),
+			maxResultLength(query.maxResultLength),
+			maxSourceWords(query.maxSourceWords),
+			requirePoolTile(query.requirePoolTile),
+			requireWord(!query.requiredWords.empty()),
+			lexicons(query.lexicons),
+			overlay(houseRules) {
+			for (std::size_t i = 0; i < std::size(words); ++i) {
+				Component component{};
+				// words with unrecognised characters can never be part of a dictionary word
+				if (!AnagramIndex::countLetters(words[i], component.counts)) { continue; }
+				component.length = std::size(words[i]);
+				component.isPoolTile = component.length == 1;
+				component.isRequired = std::find(query.requiredWords.begin(), query.requiredWords.end(), i) != query.requiredWords.end();
+				components.push_back(component);
+			}
+			std::stable_sort(components.begin(), components.end(), [](const Component& a, const Component& b) { return a.length > b.length; });
+
+			const std::size_t n{ std::size(components) };
+			suffixTotals.assign(n + 1, LetterCounts{});
+			suffixLengths.assign(n + 1, 0);
+			suffixPoolTiles.assign(n + 1, 0);
+			suffixRequired.assign(n + 1, 0);
+			for (std::size_t i = n; i-- > 0;) {
+				for (std::size_t j = 0; j < 26; ++j) {
+					suffixTotals[i][j] = suffixTotals[i + 1][j] + components[i].counts[j];
+				}
+				suffixLengths[i] = suffixLengths[i + 1] + components[i].length;
+				suffixPoolTiles[i] = suffixPoolTiles[i + 1] + components[i].isPoolTile;
+				suffixRequired[i] = suffixRequired[i + 1] + components[i].isRequired;
+			}
+		}
+
+		/**
+		 * @brief Checks whether components[i..] can still satisfy the must-use restrictions.
+		 */
+		bool canSatisfy(std::size_t i, bool usedPoolTile, bool usedRequired) const {
+			return (!requirePoolTile || usedPoolTile || suffixPoolTiles[i] > 0) &&
+				(!requireWord || usedRequired || suffixRequired[i] > 0);
+		}
+
+		/**
+		 * @brief Checks whether a combination satisfies the restrictions on its words.
+		 */
+		bool isValid(std::size_t chosen, bool usedPoolTile, bool usedRequired) const {
+			// Snatchable words are formed from at least two other words on the board
+			return chosen >= 2 && chosen <= maxSourceWords &&
+				(!requirePoolTile || usedPoolTile) && (!requireWord || usedRequired);
+		}
+	};
+
+	/**
+	 * @brief Finds snatchable words by checking every combination of words on the board.
+	 *
+	 * @param board The words on the board and the restrictions on the plays.
+	 * @param plays Receives the snatchable plays, unordered, each appearing once.
+	 */
+	template <typename Plays>
+	void generateSubsetDriven(const Board& board, Plays& plays) const {
+		std::pmr::unordered_set<std::pmr::string> seen{ board.components.get_allocator() };
+		enumerateSubsets(board, 0, LetterCounts{}, 0, 0, false, false, seen, plays);
+	}
+
+	/**
+	 * @brief Appends the words of an anagram class belonging to the queried word lists.
+	 *
+	 * Words banned by the house rules are skipped and words the house rules add with the
+	 * same letters are included.
+	 *
+	 * @param anagramClass The class in the index whose letters can be snatched, or nullptr.
+	 * @param lexicons The word lists the plays may come from.
+	 * @param overlay The house rules, or nullptr if there are none.
+	 * @param plays Output list of snatchable plays.
+	 */
+	template <typename Plays>
+	static void addPlays(const AnagramClass* anagramClass, LexiconMask lexicons, const LexiconOverlay* overlay, Plays& plays) {
+		if (overlay && anagramClass && overlay->mayAffect(anagramClass->sortedWord)) {
+			addPlays(anagramClass, lexicons, *overlay, overlay->findAddedClass(anagramClass->sortedWord), plays);
+			return;
+		}
+		if (!anagramClass) { return; }
+		for (std::size_t i = 0; i < std::size(anagramClass->anagrams); ++i) {
+			if (LexiconMask membership = anagramClass->lexicons[i] & lexicons) {
+				addPlay(plays, anagramClass->anagrams[i], membership);
+			}
+		}
+	}
+
+	/**
+	 * @brief Appends the plays of an index class and an added class with the same letters.
+	 *
+	 * @param anagramClass The class in the index, or nullptr.
+	 * @param lexicons The word lists the plays may come from.
+	 * @param overlay The house rules.
+	 * @param addedClass The class of words added by the house rules, or nullptr.
+	 * @param plays Output list of snatchable plays.
+	 */
+	template <typename Plays>
+	static void addPlays(const AnagramClass* anagramClass, LexiconMask lexicons, const LexiconOverlay& overlay, const AnagramClass* addedClass, Plays& plays) {
+		auto addedMembership = [addedClass](const std::string& word) -> LexiconMask {
+			if (!addedClass) { return 0; }
+			auto it = std::find(addedClass->anagrams.begin(), addedClass->anagrams.end(), word);
+			return it == addedClass->anagrams.end() ? 0 : addedClass->lexicons[it - addedClass->anagrams.begin()];
+		};
+		auto inIndex = [anagramClass](const std::string& word) {
+			return anagramClass && std::find(anagramClass->anagrams.begin(), anagramClass->anagrams.end(), word) != anagramClass->anagrams.end();
+		};
+
+		if (anagramClass) {
+			for (std::size_t i = 0; i < std::size(anagramClass->anagrams); ++i) {
+				const std::string& word = anagramClass->anagrams[i];
+				if (overlay.isBanned(word)) { continue; }
+				if (LexiconMask membership = (anagramClass->lexicons[i] | addedMembership(word)) & lexicons) {
+					addPlay(plays, word, membership);
+				}
+			}
+		}
+		if (addedClass) {
+			for (std::size_t i = 0; i < std::size(addedClass->anagrams); ++i) {
+				if (inIndex(addedClass->anagrams[i])) { continue; }
+				if (LexiconMask membership = addedClass->lexicons[i] & lexicons) {
+					addPlay(plays, addedClass->anagrams[i], membership);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Appends the plays of a class added by the house rules.
+	 *
+	 * @param addedClass The class of added words.
+	 * @param lexicons The word lists the plays may come from.
+	 * @param overlay The house rules.
+	 * @param plays Output list of snatchable plays.
+	 */
+	template <typename Plays>
+	void addAddedPlays(const AnagramClass& addedClass, LexiconMask lexicons, const LexiconOverlay& overlay, Plays& plays) const {
+		const AnagramClass* anagramClass = anagramIndex.findClass(addedClass.sortedWord);
+		// classes in the index which match the queried word lists have been handled already
+		if (anagramClass && (anagramClass->lexiconMask & lexicons)) { return; }
+		addPlays(anagramClass, lexicons, overlay, &addedClass, plays);
+	}
+
+	/**
+	 * @brief Visits every combination of words extending the current one with words[i..].
+	 *
+	 * Combinations which can no longer satisfy the restrictions of the query are not extended.
+	 *
+	 * @param board The words on the board and the restrictions on the plays.
+	 * @param i Index of the first word which may be added.
+	 * @param letters Letters of the current combination.
+	 * @param length Number of letters in the current combination.
+	 * @param chosen Number of words in the current combination.
+	 * @param usedPoolTile Whether the current combination contains a pool tile.
+	 * @param usedRequired Whether the current combination contains a required word.
+	 * @param seen Sorted letters of combinations which have already been looked up.
+	 * @param plays Output list of snatchable plays.
+	 */
+	template <typename Plays>
+	void enumerateSubsets(const Board& board, std::size_t i, const LetterCounts& letters, std::size_t length, std::size_t chosen,
+		bool usedPoolTile, bool usedRequired, std::pmr::unordered_set<std::pmr::string>& seen, Plays& plays) const {
+		if (chosen >= board.maxSourceWords) { return; }
+		if (length + board.suffixLengths[i] < board.minResultLength) { return; }
+		if (!board.canSatisfy(i, usedPoolTile, usedRequired)) { return; }
+
+		for (std::size_t j = i; j < std::size(board.components); ++j) {
+			const Board::Component& component = board.components[j];
+			if (length + component.length > board.maxResultLength) { continue; }
+			LetterCounts combined = letters;
+			for (std::size_t k = 0; k < 26; ++k) { combined[k] += component.counts[k]; }
+			const std::size_t combinedLength{ length + component.length };
+			const bool combinedPoolTile{ usedPoolTile || component.isPoolTile };
+			const bool combinedRequired{ usedRequired || component.isRequired };
+
+			if (combinedLength >= board.minResultLength && board.isValid(chosen + 1, combinedPoolTile, combinedRequired)) {
+				// Join all letters in the combination into one sorted string
+				std::pmr::string combinedString{ seen.get_allocator() };
+				for (std::size_t k = 0; k < 26; ++k) { combinedString.append(combined[k], static_cast<char>('A' + k)); }
+				// Different combinations can have the same letters, only report them once
+				if (seen.insert(combinedString).second) {
+					const AnagramClass* anagramClass = anagramIndex.findClass(combinedString);
+					if (anagramClass && !(anagramClass->lexiconMask & board.lexicons)) { anagramClass = nullptr; }
+					if (board.overlay && board.overlay->mayAffect(combinedString)) {
+						addPlays(anagramClass, board.lexicons, *board.overlay, board.overlay->findAddedClass(combinedString), plays);
+					}
+					else {
+						addPlays(anagramClass, board.lexicons, nullptr, plays);
+					}
+				}
+			}
+			enumerateSubsets(board, j + 1, combined, combinedLength, chosen + 1, combinedPoolTile, combinedRequired, seen, plays);
+		}
+	}
+
+	/**
+	 * @brief Finds snatchable words by checking every anagram class in the dictionary.
+	 *
+	 * Each class whose letters fit within all the letters on the board, as found by a
+	 * columnar scan of the index, is tested to see whether some combination of at least
+	 * two words on the board sums to it exactly.
+	 *
+	 * @param board The words on the board and the restrictions on the plays.
+	 * @param plays Receives the snatchable plays, unordered, each appearing once.
+	 */
+	template <typename Plays>
+	void generateDictionaryDriven(const Board& board, Plays& plays) const {
+		std::pmr::memory_resource* resource{ board.components.get_allocator().resource() };
+		// The memo is cleared for every class, so it is pooled to reuse its memory rather than
+		// leaving every class's memo behind in a monotonic resource such as a FrameArena
+		std::pmr::unsynchronized_pool_resource memoResource{ resource };
+		SubsetSumSearch search{ board, SubsetSumSearch::Memo{ &memoResource } };
+		for (std::size_t classIndex : anagramIndex.findFittingClasses(board.suffixTotals[0], board.minResultLength, board.lexicons, resource)) {
+			const AnagramClass& anagramClass = anagramIndex.getClasses()[classIndex];
+			// classes are sorted by length
+			if (std::size(anagramClass.sortedWord) > board.maxResultLength) { break; }
+			search.failed.clear();
+			if (search.canSum(0, anagramClass.counts, std::size(anagramClass.sortedWord), 0, false, false)) {
+				addPlays(&anagramClass, board.lexicons, board.overlay, plays);
+			}
+		}
+		if (board.overlay) {
+			for (const AnagramClass& addedClass : board.overlay->getAddedClasses()) {
+				const std::size_t length{ std::size(addedClass.sortedWord) };
+				if (length < board.minResultLength || length > board.maxResultLength) { continue; }
+				if (!(addedClass.lexiconMask & board.lexicons) || !AnagramIndex::fitsWithin(addedClass.counts, board.suffixTotals[0])) { continue; }
+				search.failed.clear();
+				if (search.canSum(0, addedClass.counts, length, 0, false, false)) {
+					addAddedPlays(addedClass, board.lexicons, *board.overlay, plays);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @struct Reading
+	 * @brief The letters a word or combination of words may spell, with their probability.
+	 */
+	struct Reading {
+		LetterCounts counts;
+		double probability;
+	};
+
+	/**
+	 * @brief Lists the distinct letter multisets an uncertain word may spell.
+	 *
+	 * Readings of the tiles so far are extended one tile at a time, merging readings
+	 * with the same letters and dropping those below minProbability.
+	 *
+	 * @param word Candidate letters for each tile of the word.
+	 * @param minProbability Readings below this are discarded.
+	 * @return The readings of the word, likeliest first.
+	 */
+	static std::vector<Reading> generateReadings(const UncertainWord& word, double minProbability) {
+		std::vector<Reading> readings{ Reading{ LetterCounts{}, 1.0 } };
+		for (const std::vector<LetterCandidate>& tile : word) {
+			std::unordered_map<std::string, Reading> extended{};
+			for (const Reading& reading : readings) {
+				for (const LetterCandidate& candidate : tile) {
+					if (candidate.letter < 'A' || candidate.letter > 'Z') { continue; }
+					const double probability{ reading.probability * candidate.probability };
+					if (probability < minProbability) { continue; }
+					Reading next{ reading.counts, probability };
+					++next.counts[candidate.letter - 'A'];
+					auto [it, inserted] = extended.try_emplace(std::string(next.counts.begin(), next.counts.end()), next);
+					if (!inserted) { it->second.probability += probability; }
+				}
 			}
-			return result;
+			readings.clear();
+			for (const auto& entry : extended) { readings.push_back(entry.second); }
 		}
+		std::sort(readings.begin(), readings.end(), [](const Reading& a, const Reading& b) { return a.probability > b.probability; });
+		return readings;
 	}
+
+	/**
+	 * @brief Visits every combination of words extending the current one with words[i..].
+	 *
+	 * @param readings The readings of each word on the board.
+	 * @param i Index of the first word which may be added.
+	 * @param combined The readings of the current combination.
+	 * @param chosen Number of words in the current combination.
+	 * @param lexicons The word lists the plays may come from.
+	 * @param minProbability Readings below this are discarded.
+	 * @param overlay The house rules, or nullptr if there are none.
+	 * @param bestPlays The likeliest way found so far of making each play.
+	 */
+	void enumerateReadings(const std::vector<std::vector<Reading>>& readings, std::size_t i, const std::vector<Reading>& combined, std::size_t chosen,
+		LexiconMask lexicons, double minProbability, const LexiconOverlay* overlay, std::unordered_map<std::string, ProbableSnatchablePlay>& bestPlays) const {
+		for (std::size_t j = i; j < std::size(readings); ++j) {
+			// Combine the readings of this word with the shared readings of the combination so far
+			std::unordered_map<std::string, Reading> extended{};
+			for (const Reading& prefix : combined) {
+				for (const Reading& reading : readings[j]) {
+					const double probability{ prefix.probability * reading.probability };
+					if (probability < minProbability) { break; } // readings are sorted, likeliest first
+					Reading next{ prefix.counts, probability };
+					for (std::size_t k = 0; k < 26; ++k) { next.counts[k] += reading.counts[k]; }
+					auto [it, inserted] = extended.try_emplace(std::string(next.counts.begin(), next.counts.end()), next);
+					if (!inserted) { it->second.probability += probability; }
+				}
+			}
+			if (extended.empty()) { continue; }
+
+			std::vector<Reading> next{};
+			next.reserve(std::size(extended));
+			for (const auto& entry : extended) { next.push_back(entry.second); }
+			std::sort(next.begin(), next.end(), [](const Reading& a, const Reading& b) { return a.probability > b.probability; });
+
+			// Snatchable words are formed from at least two other words on the board
+			if (chosen + 1 >= 2) {
+				for (const Reading& reading : next) {
+					std::string sortedWord;
+					for (std::size_t k = 0; k < 26; ++k) { sortedWord.append(reading.counts[k], static_cast<char>('A' + k)); }
+					const AnagramClass* anagramClass = anagramIndex.findClass(sortedWord);
+					if (anagramClass && !(anagramClass->lexiconMask & lexicons)) { anagramClass = nullptr; }
+					std::vector<SnatchablePlay> plays{};
+					if (overlay && overlay->mayAffect(sortedWord)) {
+						addPlays(anagramClass, lexicons, *overlay, overlay->findAddedClass(sortedWord), plays);
+					}
+					else {
+						addPlays(anagramClass, lexicons, nullptr, plays);
+					}
+					for (SnatchablePlay& play : plays) {
+						auto [it, inserted] = bestPlays.try_emplace(play.word, ProbableSnatchablePlay{ play.word, play.lexicons, reading.probability });
+						it->second.probability = std::max(it->second.probability, reading.probability);
+					}
+				}
+			}
+			enumerateReadings(readings, j + 1, next, chosen + 1, lexicons, minProbability, overlay, bestPlays);
+		}
+	}
+
+	/**
+	 * @struct SubsetSumSearch
+	 * @brief Memoised search for a combination of words summing to a letter multiset.
+	 */
+	struct SubsetSumSearch {
+		using Key = std::array<std::uint8_t, 32>; // remaining letters, component index, components chosen and flags
+
+		struct KeyHash {
+			std::size_t operator()(const Key& key) const {
+				return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(key.data()), std::size(key)));
+			}
+		};
+
+		using Memo = std::pmr::unordered_set<Key, KeyHash>;
+
+		const Board& board;
+		Memo failed; // states known not to reach the target
+
+		/**
+		 * @brief Checks whether components[i..] can make up the remaining letters.
+		 *
+		 * @param i Index of the next component to consider.
+		 * @param remaining Letters still to be covered.
+		 * @param remainingLength Total number of letters in remaining.
+		 * @param chosen Number of components used so far.
+		 * @param usedPoolTile Whether a pool tile has been used so far.
+		 * @param usedRequired Whether a required word has been used so far.
+		 * @return true if the letters can be covered by a combination satisfying the query.
+		 */
+		bool canSum(std::size_t i, const LetterCounts& remaining, std::size_t remainingLength, std::size_t chosen, bool usedPoolTile, bool usedRequired) {
+			if (remainingLength == 0) { return board.isValid(chosen, usedPoolTile, usedRequired); }
+			if (i == std::size(board.components) || chosen >= board.maxSourceWords) { return false; }
+			if (!board.canSatisfy(i, usedPoolTile, usedRequired)) { return false; }
+			if (!AnagramIndex::fitsWithin(remaining, board.suffixTotals[i])) { return false; }
+
+			// Beyond two words the count only matters when it is limited
+			const std::size_t chosenKey{ board.maxSourceWords == std::numeric_limits<std::size_t>::max() ? std::min<std::size_t>(chosen, 2) : chosen };
+			Key key{};
+			std::copy(remaining.begin(), remaining.end(), key.begin());
+			const std::uint16_t index{ static_cast<std::uint16_t>(i) };
+			const std::uint16_t chosenCount{ static_cast<std::uint16_t>(chosenKey) };
+			std::memcpy(&key[26], &index, sizeof(index));
+			std::memcpy(&key[28], &chosenCount, sizeof(chosenCount));
+			key[30] = static_cast<std::uint8_t>(usedPoolTile * 2 + usedRequired);
+			if (failed.contains(key)) { return false; }
+
+			const Board::Component& component = board.components[i];
+			if (component.length <= remainingLength && AnagramIndex::fitsWithin(component.counts, remaining)) {
+				LetterCounts next = remaining;
+				for (std::size_t j = 0; j < 26; ++j) { next[j] -= component.counts[j]; }
+				if (canSum(i + 1, next, remainingLength - component.length, chosen + 1,
+					usedPoolTile || component.isPoolTile, usedRequired || component.isRequired)) {
+					return true;
+				}
+			}
+			if (canSum(i + 1, remaining, remainingLength, chosen, usedPoolTile, usedRequired)) { return true; }
+
+			failed.insert(key);
+			return false;
+		}
+	};
 };
 
 #endif
@@ -0,0 +1,115 @@
+/**
+ * @file startup_timeline.h
+ * @brief Header file for the StartupTimeline class.
+ *
+ * This file contains the declaration of the StartupTimeline class, which
+ * records when each component started and finished initializing, so that a
+ * slow startup can be traced to the component responsible.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef STARTUP_TIMELINE_H
+#define STARTUP_TIMELINE_H
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <ostream>
+#include <algorithm>
+
+/**
+ * @class StartupTimeline
+ * @brief Thread safe record of the initialization of each component.
+ *
+ * Times are in milliseconds since the timeline was created. Components may be
+ * initialized concurrently on different threads.
+ */
+class StartupTimeline {
+public:
+    /**
+     * @struct Entry
+     * @brief When one component started and finished initializing.
+     */
+    struct Entry {
+        std::string component;
+        double start; // milliseconds since the timeline was created
+        double end;
+    };
+
+    StartupTimeline() : origin(std::chrono::steady_clock::now()) {}
+
+    /**
+     * @brief Runs a function and records how long it took, even if it throws.
+     *
+     * @param component Name of the component the function initializes.
+     * @param function The function to run.
+     * @return Whatever the function returns.
+     */
+    template <typename Function>
+    auto record(const std::string& component, Function function) -> decltype(function()) {
+        Recording recording{ *this, component };
+        return function();
+    }
+
+    /**
+     * @return The entries, in the order the components started.
+     */
+    std::vector<Entry> getEntries() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<Entry> sorted{ entries };
+        std::stable_sort(sorted.begin(), sorted.end(), [](const Entry& a, const Entry& b) { return a.start < b.start; });
+        return sorted;
+    }
+
+    /**
+     * @brief Prints each component's start and end time with a bar showing when it ran.
+     *
+     * @param os Stream to print to.
+     * @param width Number of characters the bar for the whole startup spans.
+     */
+    void print(std::ostream& os, int width = 40) const {
+        std::vector<Entry> sorted{ getEntries() };
+        double total{ 0.0 };
+        std::size_t nameWidth{ 0 };
+        for (const Entry& entry : sorted) {
+            total = std::max(total, entry.end);
+            nameWidth = std::max(nameWidth, std::size(entry.component));
+        }
+        for (const Entry& entry : sorted) {
+            const int from{ total > 0 ? static_cast<int>(entry.start / total * width) : 0 };
+            const int to{ total > 0 ? std::max(from + 1, static_cast<int>(entry.end / total * width)) : width };
+            os << std::left << std::setw(static_cast<int>(nameWidth)) << entry.component << std::right << std::fixed << std::setprecision(1)
+                << std::setw(9) << entry.start << " -" << std::setw(9) << entry.end << " ms |"
+                << std::string(from, ' ') << std::string(std::min(to, width) - from, '#') << std::string(width - std::min(to, width), ' ') << "|\n";
+        }
+    }
+
+private:
+    std::chrono::steady_clock::time_point origin;
+    std::vector<Entry> entries{};
+    mutable std::mutex mutex;
+
+    double now() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    /**
+     * @struct Recording
+     * @brief Adds an entry for a component when it goes out of scope.
+     */
+    struct Recording {
+        StartupTimeline& timeline;
+        std::string component;
+        double start{ timeline.now() };
+
+        ~Recording() {
+            const double end{ timeline.now() };
+            std::lock_guard<std::mutex> lock(timeline.mutex);
+            timeline.entries.push_back(Entry{ component, start, end });
+        }
+    };
+};
+
+#endif
@@ -11,8 +11,14 @@
 #ifndef TEXT_DETECTOR_H
 #define TEXT_DETECTOR_H
 #include <iostream>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <algorithm>
 #include <opencv2/opencv.hpp>
 #include <opencv2/dnn.hpp>
+#include "tile_pitch_estimator.h"
 
 /**
  * @class TextDetector
@@ -34,25 +40,212 @@ public:
         return instance;
     }
 
+    /**
+     * @brief Creates a detector of its own, e.g. for each camera of a multi-camera table.
+     *
+     * @param tilePitchEstimator Estimator for the tiles seen by this detector; it must outlive the detector.
+     * @return A new TextDetector instance.
+     */
+    static std::unique_ptr<TextDetector> createInstance(TilePitchEstimator& tilePitchEstimator) {
+        std::unique_ptr<TextDetector> detector{ new TextDetector() };
+        detector->tilePitchEstimator = &tilePitchEstimator;
+        return detector;
+    }
+
     TextDetector(const TextDetector&) = delete;
     TextDetector& operator=(const TextDetector&) = delete;
 
+    /**
+     * @brief How tiles are separated from the table.
+     *
+     * Threshold expects white tiles on a completely black background.
+     * BackgroundModel learns the empty table from the frames passed to updateBackground
+     * and detects tiles as whatever differs from it, so it works on any table surface.
+     */
+    enum class DetectionMode { Threshold, BackgroundModel };
+
+    /**
+     * @brief Sets how tiles are separated from the table.
+     *
+     * @param mode The detection mode to use from now on.
+     */
+    void setDetectionMode(DetectionMode mode) {
+        detectionMode = mode;
+        lastGrayFrame.release();
+        cachedRectangles.clear();
+    }
+
     /**
      * @brief Detects the tile locations from a raw video frame.
      * 
      * @param frame The raw frame from the video camera.
      * @return A vector containing rotated rectangles that bound the detected tiles.
      * @param verbose If true adds extra debugging information.
-     * @note Expects white tiles on a completely black background with black letters.
+     * @note In Threshold mode expects white tiles on a completely black background with black letters.
+     */
+
+    std::vector<cv::RotatedRect> getTileLocations(const cv::Mat& frame, bool verbose) {
+        return getTileLocations(frame, 1.0, verbose);
+    }
+
+    /**
+     * @brief Detects the tile locations from a frame at reduced scale, e.g. reduced luma from the camera.
+     *
+     * @param frame The frame at reduced scale, either BGR or grayscale.
+     * @param scale Full resolution pixels per pixel of frame.
+     * @param verbose If true adds extra debugging information.
+     * @return Rotated rectangles that bound the detected tiles, in full resolution coordinates.
+     */
+    std::vector<cv::RotatedRect> getTileLocations(const cv::Mat& frame, double scale, bool verbose) {
+        std::vector<cv::RotatedRect> rotatedRectangles{};
+        if (detectionMode == DetectionMode::BackgroundModel) {
+            rotatedRectangles = getForegroundTileLocations(frame, scale, verbose);
+        }
+        else {
+            cv::Mat processedFrame = preprocessFrame(frame);
+
+            // Find contours - because there are white tiles on a black background
+            // the contours should be squares
+            rotatedRectangles = findTiles(processedFrame);
+            keepPlausibleSizes(rotatedRectangles, scale, true);
+
+            if (verbose) displayDetectedTiles(processedFrame, rotatedRectangles);
+            if (verbose) std::cout << "Number of tiles recognized: " << std::size(rotatedRectangles) << std::endl;
+        }
+        if (scale == 1.0) return rotatedRectangles;
+        for (cv::RotatedRect& rotatedRect : rotatedRectangles) {
+            rotatedRect.center *= static_cast<float>(scale);
+            rotatedRect.size.width *= static_cast<float>(scale);
+            rotatedRect.size.height *= static_cast<float>(scale);
+        }
+        return rotatedRectangles;
+    }
+
+    /**
+     * @brief Updates the model of the empty table with a new frame.
+     *
+     * The first frame, or a frame of a new size, becomes the background. After that
+     * the background slowly follows lighting changes, except where tiles are detected.
+     * Lighting changes slowly, so only every backgroundUpdateInterval-th frame is
+     * examined, with a learning rate which makes up for the frames skipped.
+     *
+     * @param frame The raw frame from the video camera.
+     * @note Tiles already on the table in the first frame become part of the background for good:
+     *       they are never detected, and once taken the bare table where they lay is detected as a tile.
      */
+    void updateBackground(const cv::Mat& frame) {
+        const bool newBackground{ background.empty() || background.size() != frame.size() };
+        if (!newBackground && ++framesSinceBackgroundUpdate < backgroundUpdateInterval) return;
+        framesSinceBackgroundUpdate = 0;
 
-    std::vector<cv::RotatedRect> getTileLocations(const cv::Mat& frame, bool verbose) const {
-        cv::Mat processedFrame = preprocessFrame(frame);
+        cv::Mat grayFrame{ preprocessGrayFrame(frame) };
+        if (newBackground) {
+            grayFrame.convertTo(background, CV_32F);
+            return;
+        }
+        cv::Mat tableMask;
+        cv::bitwise_not(foregroundMask(grayFrame), tableMask);
+        const double learningRate{ 1.0 - std::pow(1.0 - backgroundLearningRate, backgroundUpdateInterval) };
+        cv::accumulateWeighted(grayFrame, background, learningRate, tableMask);
+    }
 
-        // Find contours - because there are white tiles on a black background
-        // the contours should be squares
+    /**
+     * @brief Finds the external contours of a black and white image, searching horizontal strips in parallel.
+     *
+     * A region crossing a seam between strips is found as one contour in each strip.
+     * The runs of white pixels on the rows either side of each seam are matched to the
+     * contours they belong to, and contours whose runs touch across the seam, including
+     * diagonally, are merged. Only the points of the merged contours are kept, not their
+     * order, which is all minAreaRect needs.
+     *
+     * @param binary Black and white image for contour detection.
+     * @param numStrips Number of strips, 1 to search the whole image at once.
+     * @param offset Offset added to the contours, when binary is a region of the frame.
+     * @return The points of each external contour.
+     */
+    static std::vector<std::vector<cv::Point>> findContoursInStrips(const cv::Mat& binary, int numStrips, const cv::Point& offset = cv::Point()) {
         std::vector<std::vector<cv::Point>> contours;
-        cv::findContours(processedFrame, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+        numStrips = std::clamp(numStrips, 1, std::max(1, binary.rows));
+        if (numStrips == 1) {
+            cv::findContours(binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE, offset);
+            return contours;
+        }
+
+        // Search each strip in parallel
+        std::vector<int> seams(numStrips + 1); // first row of each strip, and the end of the image
+        for (int k = 0; k <= numStrips; ++k) seams[k] = binary.rows * k / numStrips;
+        std::vector<std::vector<std::vector<cv::Point>>> stripContours(numStrips);
+        cv::parallel_for_(cv::Range(0, numStrips), [&](const cv::Range& range) {
+            for (int k = range.start; k < range.end; ++k) {
+                cv::findContours(binary.rowRange(seams[k], seams[k + 1]), stripContours[k], cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE,
+                    offset + cv::Point(0, seams[k]));
+            }
+        });
+        std::vector<std::size_t> firstContour(numStrips + 1); // index of the first contour of each strip, and the end
+        for (int k = 0; k < numStrips; ++k) {
+            firstContour[k] = std::size(contours);
+            for (std::vector<cv::Point>& contour : stripContours[k]) contours.push_back(std::move(contour));
+        }
+        firstContour[numStrips] = std::size(contours);
+
+        // Union contours whose runs touch across a seam
+        std::vector<std::size_t> parent(std::size(contours));
+        std::iota(parent.begin(), parent.end(), 0);
+        auto find = [&parent](std::size_t i) {
+            while (parent[i] != i) i = parent[i] = parent[parent[i]];
+            return i;
+        };
+        for (int k = 1; k < numStrips; ++k) {
+            const std::vector<SeamRun> above{ findSeamRuns(binary, seams[k] - 1, contours, firstContour[k - 1], firstContour[k], offset) };
+            const std::vector<SeamRun> below{ findSeamRuns(binary, seams[k], contours, firstContour[k], firstContour[k + 1], offset) };
+            for (std::size_t i = 0, j = 0; i < std::size(above) && j < std::size(below);) {
+                if (above[i].left <= below[j].right + 1 && below[j].left <= above[i].right + 1) parent[find(above[i].contour)] = find(below[j].contour);
+                if (above[i].right < below[j].right) ++i;
+                else ++j;
+            }
+        }
+
+        // Gather the points of each merged contour into its root
+        std::vector<std::vector<cv::Point>> mergedContours{};
+        std::vector<std::size_t> mergedIndex(std::size(contours), SIZE_MAX);
+        for (std::size_t i = 0; i < std::size(contours); ++i) {
+            const std::size_t root{ find(i) };
+            if (mergedIndex[root] == SIZE_MAX) {
+                mergedIndex[root] = std::size(mergedContours);
+                mergedContours.emplace_back();
+            }
+            std::vector<cv::Point>& merged = mergedContours[mergedIndex[root]];
+            merged.insert(merged.end(), contours[i].begin(), contours[i].end());
+        }
+        return mergedContours;
+    }
+
+private:
+    static constexpr double aspectRatioLowerBound{ 0.8 };
+    static constexpr double aspectRatioUpperBound{ 1.2 };
+    static constexpr double foregroundThreshold{ 30 };
+    static constexpr double backgroundLearningRate{ 0.02 };
+    static constexpr int backgroundUpdateInterval{ 10 }; // frames per update of the background model
+    static constexpr int changedRegionMargin{ 16 };
+    static constexpr int tileRegionMargin{ 4 }; // pixels around a tile the foreground mask's filters need to see
+    static constexpr std::size_t minParallelPixels{ 1920 * 1080 }; // smaller frames are not worth splitting
+    static constexpr int minStripRows{ 128 };
+    DetectionMode detectionMode{ DetectionMode::Threshold };
+    cv::Mat background{}; // running average of the empty table, CV_32F
+    int framesSinceBackgroundUpdate{ 0 };
+    cv::Mat lastGrayFrame{}; // frame the cached rectangles were detected in
+    std::vector<cv::RotatedRect> cachedRectangles{};
+    TilePitchEstimator* tilePitchEstimator{ &TilePitchEstimator::getInstance() };
+
+    /**
+     * @brief Finds the square shaped white regions of a black and white image.
+     *
+     * @param processedFrame Black and white image for contour detection.
+     * @param offset Offset added to the contours, when processedFrame is a region of the frame.
+     * @return Rotated rectangles bounding the regions with an acceptable aspect ratio.
+     */
+    std::vector<cv::RotatedRect> findTiles(const cv::Mat& processedFrame, const cv::Point& offset = cv::Point()) const {
+        std::vector<std::vector<cv::Point>> contours{ findContoursInStrips(processedFrame, numStripsFor(processedFrame), offset) };
 
         std::vector<cv::RotatedRect> rotatedRectangles{};
         for (size_t i = 0; i < contours.size(); ++i) {
@@ -64,15 +257,168 @@ public:
             if ((aspectRatio > aspectRatioUpperBound) || (aspectRatio < aspectRatioLowerBound)) continue;
             rotatedRectangles.push_back(rotatedRect);
         }
+        return rotatedRectangles;
+    }
+
+    /**
+     * @brief Removes the regions much larger or smaller than a tile.
+     *
+     * Regions found over the whole frame first update the tile size estimate. Regions
+     * found in a changed part of the frame do not, since only the tiles near a move
+     * are there and they would outweigh the rest of the board.
+     *
+     * @param rotatedRectangles Regions with an acceptable aspect ratio, as returned by findTiles.
+     * @param scale Full resolution pixels per pixel of the regions' coordinates.
+     * @param wholeFrame true if the regions were found over the whole frame.
+     */
+    void keepPlausibleSizes(std::vector<cv::RotatedRect>& rotatedRectangles, double scale, bool wholeFrame) {
+        if (wholeFrame) tilePitchEstimator->update(rotatedRectangles, scale);
+        std::erase_if(rotatedRectangles, [&](const cv::RotatedRect& rotatedRect) { return !tilePitchEstimator->isPlausibleSize(rotatedRect, scale); });
+    }
+
+    /**
+     * @struct SeamRun
+     * @brief A run of white pixels on a row next to a seam between strips, and the contour it belongs to.
+     */
+    struct SeamRun {
+        int left;
+        int right;
+        std::size_t contour;
+    };
+
+    /**
+     * @return Number of strips to search a black and white image in, one per thread for large images.
+     */
+    static int numStripsFor(const cv::Mat& binary) {
+        if (binary.total() < minParallelPixels) return 1;
+        return std::max(1, std::min(cv::getNumThreads(), binary.rows / minStripRows));
+    }
 
-        if (verbose) displayDetectedTiles(processedFrame, rotatedRectangles);
-        if (verbose) std::cout << "Number of tiles recognized: " << std::size(rotatedRectangles) << std::endl;
+    /**
+     * @brief Finds the runs of white pixels on the first or last row of a strip and the contour of each.
+     *
+     * Every white pixel on the edge row of a strip is on the external contour of its region,
+     * and CHAIN_APPROX_SIMPLE keeps the ends of each run, so each run holds a point of its contour.
+     *
+     * @param binary Black and white image for contour detection.
+     * @param row The row, in the coordinates of binary.
+     * @param contours The contours of all strips.
+     * @param firstContour Index of the first contour of the strip.
+     * @param endContour One past the index of the last contour of the strip.
+     * @param offset Offset which was added to the contours.
+     * @return The runs from left to right.
+     */
+    static std::vector<SeamRun> findSeamRuns(const cv::Mat& binary, int row, const std::vector<std::vector<cv::Point>>& contours,
+        std::size_t firstContour, std::size_t endContour, const cv::Point& offset) {
+        std::vector<std::size_t> labels(binary.cols, SIZE_MAX);
+        for (std::size_t i = firstContour; i < endContour; ++i) {
+            for (const cv::Point& point : contours[i]) {
+                if (point.y - offset.y == row) labels[point.x - offset.x] = i;
+            }
+        }
+
+        std::vector<SeamRun> runs{};
+        const uchar* pixels{ binary.ptr<uchar>(row) };
+        for (int x = 0; x < binary.cols; ++x) {
+            if (!pixels[x]) continue;
+            SeamRun run{ x, x, SIZE_MAX };
+            for (; x < binary.cols && pixels[x]; ++x) {
+                run.right = x;
+                if (labels[x] != SIZE_MAX) run.contour = labels[x];
+            }
+            if (run.contour != SIZE_MAX) runs.push_back(run);
+        }
+        return runs;
+    }
+
+    /**
+     * @brief Detects tiles as the foreground of the background model.
+     *
+     * Only the region which changed since the last detection is examined; tiles
+     * outside it are taken from the previous result.
+     *
+     * @param frame The raw frame from the video camera.
+     * @param scale Full resolution pixels per pixel of frame.
+     * @param verbose If true adds extra debugging information.
+     * @return A vector containing rotated rectangles that bound the detected tiles.
+     */
+    std::vector<cv::RotatedRect> getForegroundTileLocations(const cv::Mat& frame, double scale, bool verbose) {
+        cv::Mat grayFrame{ preprocessGrayFrame(frame) };
+        if (background.empty() || background.size() != grayFrame.size()) updateBackground(frame);
+
+        const cv::Rect frameRect(0, 0, grayFrame.cols, grayFrame.rows);
+        cv::Rect roi{ frameRect };
+        if (!lastGrayFrame.empty() && lastGrayFrame.size() == grayFrame.size()) {
+            cv::Mat changed;
+            cv::absdiff(grayFrame, lastGrayFrame, changed);
+            cv::threshold(changed, changed, foregroundThreshold, 255, cv::THRESH_BINARY);
+            if (cv::countNonZero(changed) == 0) {
+                if (verbose) std::cout << "Number of tiles recognized: " << std::size(cachedRectangles) << " (unchanged)" << std::endl;
+                return cachedRectangles;
+            }
+
+            // Grow the changed region until it cuts through no cached tile, since covering
+            // one tile can make the region overlap its neighbours in the same word
+            const cv::Rect changedRect{ cv::boundingRect(changed) };
+            roi = cv::Rect(changedRect.tl() - cv::Point(changedRegionMargin, changedRegionMargin),
+                changedRect.br() + cv::Point(changedRegionMargin, changedRegionMargin)) & frameRect;
+            for (bool grown = true; grown;) {
+                grown = false;
+                for (const cv::RotatedRect& rotatedRect : cachedRectangles) {
+                    const cv::Rect boundingRect{ rotatedRect.boundingRect() };
+                    const cv::Rect tileRect{ cv::Rect(boundingRect.x - tileRegionMargin, boundingRect.y - tileRegionMargin,
+                        boundingRect.width + 2 * tileRegionMargin, boundingRect.height + 2 * tileRegionMargin) & frameRect };
+                    const cv::Rect overlap{ tileRect & roi };
+                    if (overlap.area() > 0 && overlap != tileRect) {
+                        roi |= tileRect;
+                        grown = true;
+                    }
+                }
+            }
+        }
+
+        // Keep cached tiles outside the region and detect the tiles inside it again
+        std::vector<cv::RotatedRect> rotatedRectangles{};
+        for (const cv::RotatedRect& rotatedRect : cachedRectangles) {
+            if ((rotatedRect.boundingRect() & roi).area() == 0) rotatedRectangles.push_back(rotatedRect);
+        }
+        cv::Mat processedRegion{ foregroundMask(grayFrame(roi), roi) };
+        std::vector<cv::RotatedRect> regionRectangles{ findTiles(processedRegion, roi.tl()) };
+        keepPlausibleSizes(regionRectangles, scale, roi == frameRect);
+        rotatedRectangles.insert(rotatedRectangles.end(), regionRectangles.begin(), regionRectangles.end());
+
+        lastGrayFrame = grayFrame;
+        cachedRectangles = rotatedRectangles;
+
+        if (verbose) {
+            cv::Mat processedFrame{ cv::Mat::zeros(grayFrame.size(), CV_8U) };
+            processedRegion.copyTo(processedFrame(roi));
+            displayDetectedTiles(processedFrame, rotatedRectangles);
+            std::cout << "Number of tiles recognized: " << std::size(rotatedRectangles) << std::endl;
+        }
         return rotatedRectangles;
     }
 
-private:
-    static constexpr double aspectRatioLowerBound{ 0.8 };
-    static constexpr double aspectRatioUpperBound{ 1.2 };
+    /**
+     * @brief Separates the tiles from the table using the background model.
+     *
+     * @param grayFrame Grayscale frame, or a region of it.
+     * @param roi Region of the frame grayFrame covers, empty for the whole frame.
+     * @return Black and white image, with white where the frame differs from the background.
+     */
+    cv::Mat foregroundMask(const cv::Mat& grayFrame, const cv::Rect& roi = cv::Rect()) const {
+        cv::Mat backgroundRegion;
+        background(roi.empty() ? cv::Rect(0, 0, background.cols, background.rows) : roi).convertTo(backgroundRegion, CV_8U);
+        cv::Mat mask;
+        cv::absdiff(grayFrame, backgroundRegion, mask);
+        cv::threshold(mask, mask, foregroundThreshold, 255, cv::THRESH_BINARY);
+
+        // Fill the letters in and separate tiles which touch
+        cv::Mat kernel{ cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3)) };
+        cv::morphologyEx(mask, mask, cv::MORPH_CLOSE, kernel);
+        cv::erode(mask, mask, kernel);
+        return mask;
+    }
     
     /**
      * @brief Displays rotated rectangles of detected tiles on the preprocessed image.
@@ -109,16 +455,31 @@ private:
      * @note Contour detection requires white shapes on a black background
      */
     cv::Mat preprocessFrame(const cv::Mat& frame) const {
-        cv::Mat preprocessedFrame;
+        cv::Mat preprocessedFrame{ preprocessGrayFrame(frame) };
 
-        // Convert to gray, blur, and apply thresholding / canny edge detection
-        cv::cvtColor(frame, preprocessedFrame, cv::COLOR_BGR2GRAY);
-        cv::GaussianBlur(preprocessedFrame, preprocessedFrame, cv::Size(5, 5), 0);
+        // Apply thresholding / canny edge detection
         cv::threshold(preprocessedFrame, preprocessedFrame, 200, 255, cv::THRESH_BINARY);
 
         return preprocessedFrame;
     }
 
+    /**
+     * @brief Converts a raw frame to a blurred grayscale image.
+     *
+     * @param frame The raw frame from the video camera, either BGR or grayscale.
+     * @return Blurred grayscale image.
+     */
+    cv::Mat preprocessGrayFrame(const cv::Mat& frame) const {
+        cv::Mat grayFrame;
+
+        // Convert to gray, unless the frame is already luma, and blur
+        if (frame.channels() == 3) cv::cvtColor(frame, grayFrame, cv::COLOR_BGR2GRAY);
+        else frame.copyTo(grayFrame);
+        cv::GaussianBlur(grayFrame, grayFrame, cv::Size(5, 5), 0);
+
+        return grayFrame;
+    }
+
     /**
      * @brief Private constructor to prevent instantiation.
      *
@@ -13,13 +13,21 @@
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <memory>
+#include <optional>
+#include <array>
+#include <numeric>
 #include <fstream>
+#include <span>
+#include <memory_resource>
 #include <opencv2/opencv.hpp>
 #include <leptonica/allheaders.h>
 #include <tesseract/ocrclass.h>
 #include <tesseract/baseapi.h>
+#include <tesseract/resultiterator.h>
 #include "letter_node.h"
 #include "letter_node_utils.h"
+#include "tile_pitch_estimator.h"
 
 
 /**
@@ -43,9 +51,81 @@ public:
         return instance;
     }
 
+    /**
+     * @brief Creates a recognizer with its own tesseract engine, e.g. for each worker thread.
+     *
+     * @param tilePitchEstimator Estimator for the tiles seen by this recognizer; it must outlive the recognizer.
+     * @param lang The tesseract model to load, e.g. "tiles" for the model built by the tile_model target.
+     * @return A new TextRecognizer instance.
+     * @throw std::runtime_error If tesseract cannot be initialized.
+     */
+    static std::unique_ptr<TextRecognizer> createInstance(TilePitchEstimator& tilePitchEstimator = TilePitchEstimator::getInstance(), const std::string& lang = "eng") {
+        std::unique_ptr<TextRecognizer> recognizer{ new TextRecognizer(NULL, lang) };
+        recognizer->tilePitchEstimator = &tilePitchEstimator;
+        return recognizer;
+    }
+
     TextRecognizer(const TextRecognizer&) = delete;
     TextRecognizer& operator=(const TextRecognizer&) = delete;
 
+    /**
+     * @brief Replaces the tesseract model, keeping all other settings.
+     *
+     * @param lang The tesseract model to load from the tessdata directory.
+     * @throw std::runtime_error If tesseract cannot be initialized with the model.
+     */
+    void loadModel(const std::string& lang) {
+        tess.End();
+        initTesseract(NULL, lang);
+    }
+
+    /**
+     * @brief Recognizes a synthetic tile, so the first real frame does not pay for tesseract's lazy initialization.
+     */
+    void warmUp() {
+        const int margin{ warmUpTileLength / 8 };
+        cv::Mat frame(warmUpTileLength, warmUpTileLength, CV_8UC3, cv::Scalar(0, 0, 0));
+        const cv::Rect tile(margin, margin, warmUpTileLength - 2 * margin, warmUpTileLength - 2 * margin);
+        cv::rectangle(frame, tile, cv::Scalar(255, 255, 255), cv::FILLED);
+        cv::putText(frame, "A", cv::Point(3 * margin, warmUpTileLength - 3 * margin), cv::FONT_HERSHEY_SIMPLEX, 2.0, cv::Scalar(0, 0, 0), 6);
+        const cv::RotatedRect rotatedRect(cv::Point2f(warmUpTileLength / 2.0f, warmUpTileLength / 2.0f), cv::Size2f(tile.size()), 0.0f);
+        recognizeLetterNodes(frame, { rotatedRect }, false);
+    }
+
+    /**
+     * @brief How the letters on the tiles are recognized.
+     *
+     * PerTile runs single character OCR on each tile, in the orientation shared by its word.
+     * WholeWord lays each word out as one strip and recognizes it with a word OCR call in
+     * each of the two orientations along the word, only falling back to PerTile for tiles
+     * where the strip result is inconsistent.
+     */
+    enum class RecognitionMode { PerTile, WholeWord };
+
+    /**
+     * @brief Sets how the letters on the tiles are recognized.
+     *
+     * @param mode The recognition mode to use from now on.
+     */
+    void setRecognitionMode(RecognitionMode mode) {
+        recognitionMode = mode;
+    }
+
+    /**
+     * @brief Sets the recent frames used to fuse the crops of small tiles.
+     *
+     * Tiles on the far side of the table can be only a few tens of pixels wide. Their
+     * crops from every recent frame are registered to the crop from the processed frame
+     * and averaged, which removes noise and, since the sub-pixel shifts differ between
+     * frames, recovers some detail lost by upsampling a single crop.
+     *
+     * @param frames Recent frames from the same camera other than the processed frame, e.g. from
+     *        FrameRing::getFramesExceptSharpest; empty to disable fusion.
+     */
+    void setRecentFrames(std::vector<cv::Mat> frames) {
+        recentFrames = std::move(frames);
+    }
+
     /**
      * @brief Generates current words on the board from a raw frame and locations of tiles.
      * 
@@ -56,8 +136,23 @@ public:
      * @return Vector containing the words currently on the board.
      */
     std::vector<std::string> generateWords(const cv::Mat& frame, const std::vector<cv::RotatedRect>& rotatedRectangles, const std::string& windowName, bool verbose) {
+        std::pmr::vector<std::pmr::string> words{ generateWords(frame, rotatedRectangles, windowName, verbose, std::pmr::get_default_resource()) };
+        return std::vector<std::string>(words.begin(), words.end());
+    }
+
+    /**
+     * @brief Generates current words on the board, allocating the letter nodes, graph and words from a memory resource.
+     *
+     * @param frame The raw frame from the video camera.
+     * @param rotatedRectangles Represents the location of the tiles within the frame.
+     * @param windowName Reference to the main window for OCR results display.
+     * @param verbose If true adds extra debugging information.
+     * @param resource Memory resource for the frame's transient data, e.g. a FrameArena.
+     * @return Vector containing the words currently on the board.
+     */
+    std::pmr::vector<std::pmr::string> generateWords(const cv::Mat& frame, const std::vector<cv::RotatedRect>& rotatedRectangles, const std::string& windowName, bool verbose,
+        std::pmr::memory_resource* resource) {
         cv::Mat frameForDisplay = frame.clone();
-        std::vector<LetterNode> letterNodes{};
         for (const auto& rotatedRectangle: rotatedRectangles) {
             // display rectangle
             cv::Point2f vertices[4]; // get vertices of rect for drawing
@@ -66,37 +161,156 @@ public:
                 int thickness{ 2 };
                 cv::line(frameForDisplay, vertices[j], vertices[(j + 1) % 4], colourGreen, thickness);
             }
+        }
 
-            // recognize letter
-            std::optional<char> letter{ recognizeLetter(frame, rotatedRectangle, verbose) };
-            if (letter) {
-                LetterNode letterNode{ *letter, rotatedRectangle };
-                letterNodes.push_back(letterNode);
-                // add letter text to display
-                std::string letterText(1, *letter);
-                int fontFace = cv::FONT_HERSHEY_SIMPLEX;
-                double fontScale = 0.5;
-                int textThickness = 1;
-                cv::Point2f textPosition = rotatedRectangle.center;
-                cv::putText(frameForDisplay, letterText, textPosition, fontFace, fontScale, cv::Scalar{ 0, 0, 255 }, textThickness);
-            }
+        std::pmr::vector<LetterNode> letterNodes{ recognizeLetterNodes(frame, rotatedRectangles, verbose, resource) };
+        for (const LetterNode& letterNode : letterNodes) {
+            // add letter text to display
+            std::string letterText(1, letterNode.letter);
+            int fontFace = cv::FONT_HERSHEY_SIMPLEX;
+            double fontScale = 0.5;
+            int textThickness = 1;
+            cv::Point2f textPosition = letterNode.rect.center;
+            cv::putText(frameForDisplay, letterText, textPosition, fontFace, fontScale, cv::Scalar{ 0, 0, 255 }, textThickness);
         }
-        std::unordered_map<LetterNode, std::unordered_set<LetterNode>> letterNodeGraph{ LetterNodeUtils::createLetterNodeGraph(letterNodes, LetterNodeUtils::boundingBoxAdjacencyStrategy) };
-        std::vector<std::string> words{ LetterNodeUtils::findConnectedComponents(letterNodeGraph)};
+        std::pmr::vector<std::pmr::string> words{ connectLetterNodes(letterNodes, resource) };
         cv::imshow(windowName, frameForDisplay);
+        annotatedFrame = frameForDisplay;
         if (verbose) {
             std::cout << "Words:\n";
-            std::for_each(words.begin(), words.end(), [](std::string x) { std::cout << x << std::endl; });
+            std::for_each(words.begin(), words.end(), [](const std::pmr::string& x) { std::cout << x << std::endl; });
         }
         return words;
     }
 
+    /**
+     * @return The frame with the tiles and letters drawn on it, from the last call to generateWords which displays it.
+     */
+    const cv::Mat& getAnnotatedFrame() const {
+        return annotatedFrame;
+    }
+
+    /**
+     * @brief Generates current words on the board without displaying anything.
+     *
+     * Used when processing recorded footage rather than the live camera feed.
+     *
+     * @param frame The raw frame from the video.
+     * @param rotatedRectangles Represents the location of the tiles within the frame.
+     * @return Vector containing the words currently on the board.
+     */
+    std::vector<std::string> generateWords(const cv::Mat& frame, const std::vector<cv::RotatedRect>& rotatedRectangles) {
+        return connectLetterNodes(recognizeLetterNodes(frame, rotatedRectangles, false));
+    }
+
+    /**
+     * @brief Recognizes the letter on each tile.
+     *
+     * @param frame The raw frame from the video camera.
+     * @param rotatedRectangles Represents the location of the tiles within the frame.
+     * @param verbose If true adds extra debugging information.
+     * @return A letter node for every tile whose letter could be recognized.
+     */
+    std::vector<LetterNode> recognizeLetterNodes(const cv::Mat& frame, const std::vector<cv::RotatedRect>& rotatedRectangles, bool verbose) {
+        std::pmr::vector<LetterNode> letterNodes{ recognizeLetterNodes(frame, rotatedRectangles, verbose, std::pmr::get_default_resource()) };
+        return std::vector<LetterNode>(letterNodes.begin(), letterNodes.end());
+    }
+
+    /**
+     * @brief Recognizes the letter on each tile, allocating the letter nodes from a memory resource.
+     *
+     * @param frame The raw frame from the video camera.
+     * @param rotatedRectangles Represents the location of the tiles within the frame.
+     * @param verbose If true adds extra debugging information.
+     * @param resource Memory resource for the letter nodes and the grouping of the tiles, e.g. a FrameArena.
+     * @return A letter node for every tile whose letter could be recognized.
+     */
+    std::pmr::vector<LetterNode> recognizeLetterNodes(const cv::Mat& frame, const std::vector<cv::RotatedRect>& rotatedRectangles, bool verbose,
+        std::pmr::memory_resource* resource) {
+        std::pmr::vector<LetterNode> letterNodes{ resource };
+        for (const std::pmr::vector<std::size_t>& component : groupAdjacentTiles(rotatedRectangles, resource)) {
+            std::pmr::vector<std::optional<char>> letters(std::size(component), resource);
+            if (recognitionMode == RecognitionMode::WholeWord && std::size(component) > 1) {
+                recognizeStrip(frame, rotatedRectangles, component, letters, verbose);
+            }
+
+            // Recognize the tiles on their own where there was no strip or it was inconsistent
+            std::pmr::vector<std::size_t> remaining{ resource };
+            std::pmr::vector<std::size_t> remainingTiles{ resource };
+            for (std::size_t i = 0; i < std::size(component); ++i) {
+                if (letters[i]) continue;
+                remaining.push_back(i);
+                remainingTiles.push_back(component[i]);
+            }
+            std::pmr::vector<std::optional<char>> remainingLetters(std::size(remainingTiles), resource);
+            recognizeComponent(frame, rotatedRectangles, remainingTiles, remainingLetters, verbose, resource);
+            for (std::size_t j = 0; j < std::size(remaining); ++j) {
+                letters[remaining[j]] = remainingLetters[j];
+            }
+
+            for (std::size_t i = 0; i < std::size(component); ++i) {
+                if (letters[i]) letterNodes.push_back(LetterNode{ *letters[i], rotatedRectangles[component[i]] });
+            }
+        }
+        return letterNodes;
+    }
+
+    /**
+     * @brief Groups recognized letters into words by connecting adjacent tiles.
+     *
+     * @param letterNodes The recognized letters.
+     * @return Vector containing one word per connected group of tiles.
+     */
+    static std::vector<std::string> connectLetterNodes(const std::vector<LetterNode>& letterNodes) {
+        // Only tiles in neighbouring grid cells need comparing
+        const float cellSize{ LetterNodeUtils::pitchAdjacencyCellSize(letterNodes) };
+        std::unordered_map<LetterNode, std::unordered_set<LetterNode>> letterNodeGraph{ cellSize > 0
+            ? LetterNodeUtils::createLetterNodeGraph(letterNodes, LetterNodeUtils::pitchAdjacencyStrategy, cellSize)
+            : LetterNodeUtils::createLetterNodeGraph(letterNodes, LetterNodeUtils::pitchAdjacencyStrategy) };
+        return LetterNodeUtils::findConnectedComponents(letterNodeGraph);
+    }
+
+    /**
+     * @brief Groups recognized letters into words, allocating the graph and words from a memory resource.
+     *
+     * @param letterNodes The recognized letters.
+     * @param resource Memory resource for the graph and the words, e.g. a FrameArena.
+     * @return Vector containing one word per connected group of tiles.
+     */
+    static std::pmr::vector<std::pmr::string> connectLetterNodes(std::span<const LetterNode> letterNodes, std::pmr::memory_resource* resource) {
+        const float cellSize{ LetterNodeUtils::pitchAdjacencyCellSize(letterNodes) };
+        LetterNodeUtils::PmrLetterNodeGraph letterNodeGraph{ cellSize > 0
+            ? LetterNodeUtils::createLetterNodeGraph(letterNodes, LetterNodeUtils::pitchAdjacencyStrategy, cellSize, resource)
+            : LetterNodeUtils::createLetterNodeGraph(letterNodes, LetterNodeUtils::pitchAdjacencyStrategy, resource) };
+        return LetterNodeUtils::findConnectedComponents(letterNodeGraph, resource);
+    }
+
 private:
+    /**
+     * @struct LetterGuess
+     * @brief A letter recognized on a tile and the orientation it was read in.
+     */
+    struct LetterGuess {
+        char letter;
+        int confidence;
+        int quarterTurns; // clockwise quarter turns of the preprocessed tile
+    };
+
     tesseract::TessBaseAPI tess;
     static constexpr int userDefinedDpi{ 300 };
     static inline const char* userDefinedDpiStr = "300";
     static constexpr double tileLengthInches{ 0.708661 };
     static inline cv::Scalar colourGreen{ 0, 255, 0 };
+    static constexpr int CONFIDENCE_THRESHOLD{ 50 };
+    static constexpr std::array<int, 4> allQuarterTurns{ 1, 2, 3, 0 };
+    RecognitionMode recognitionMode{ RecognitionMode::PerTile };
+    TilePitchEstimator* tilePitchEstimator{ &TilePitchEstimator::getInstance() };
+    std::vector<cv::Mat> recentFrames{};
+    cv::Mat annotatedFrame{};
+    static constexpr float smallTileLengthPixels{ 40.0f };
+    static constexpr double minRegistrationResponse{ 0.2 };
+    static constexpr int tileRegionMargin{ 4 }; // pixels around a tile kept for interpolation when rotating it
+    static constexpr int warmUpTileLength{ 128 };
 
     /**
      * @brief Private constructor to prevent instantiation.
@@ -105,8 +319,19 @@ private:
      * @param lang The language for Tesseract OCR.
      */
     TextRecognizer(const char* dataPath = NULL, const std::string& lang = "eng") {
+        initTesseract(dataPath, lang);
+    }
+
+    /**
+     * @brief Initializes tesseract for single character recognition of tiles.
+     *
+     * @param dataPath The path to the Tesseract data files.
+     * @param lang The language for Tesseract OCR.
+     * @throw std::runtime_error If tesseract cannot be initialized.
+     */
+    void initTesseract(const char* dataPath, const std::string& lang) {
         if (tess.Init(dataPath, lang.c_str(), tesseract::OEM_LSTM_ONLY)) {
-            throw std::runtime_error("Could not initialize tesseract.");
+            throw std::runtime_error("Could not initialize tesseract with model " + lang + ".");
         }
         tess.SetPageSegMode(tesseract::PSM_SINGLE_CHAR);  // Detect orientation AND recognize text
 
@@ -116,49 +341,342 @@ private:
     }
 
     /**
-     * @brief Recognizes a single character within a given rotated rectangle.
+     * @brief Recognizes the tiles of a word, finding the word's orientation first.
+     *
+     * Tiles within a word share an orientation. The word's principal axis leaves two
+     * candidate orientations, which are tried on the highest contrast tile (or the next
+     * one if that fails). The remaining tiles are then only read in the orientation found,
+     * falling back to all four orientations if none could be found.
      *
      * @param frame The raw frame from the video camera.
-     * @param rotatedRect The rotated rectangle containing the tile.
+     * @param rotatedRectangles Represents the location of the tiles within the frame.
+     * @param tiles Indices into rotatedRectangles of the tiles in the word.
+     * @param letters Receives the letter on each tile, or nullopt where it could not be recognized.
      * @param verbose If true adds extra debugging information.
-     * @return An optional single character if text can be recognized.
+     * @param resource Memory resource for the scratch space of the word.
      */
-    std::optional<char> recognizeLetter(const cv::Mat& frame, const cv::RotatedRect& rotatedRect, bool verbose) {
-        constexpr int CONFIDENCE_THRESHOLD = 50; // Define a clear threshold
-        cv::Mat preprocessedImage = preprocessImage(frame, rotatedRect);
+    void recognizeComponent(const cv::Mat& frame, const std::vector<cv::RotatedRect>& rotatedRectangles,
+        std::span<const std::size_t> tiles, std::span<std::optional<char>> letters, bool verbose, std::pmr::memory_resource* resource) {
+        const std::size_t n{ std::size(tiles) };
+        std::pmr::vector<cv::Mat> tileImages{ resource };
+        std::pmr::vector<double> contrasts{ resource };
+        for (std::size_t i : tiles) {
+            tileImages.push_back(preprocessImage(frame, rotatedRectangles[i]));
+            contrasts.push_back(tileContrast(frame, rotatedRectangles[i]));
+        }
 
-        std::optional<char> bestGuess = std::nullopt;
-        int bestGuessConfidence = 0;
+        // Probe up to two of the highest contrast tiles for the direction the word is upright in
+        std::optional<cv::Point2f> axis{ principalAxis(rotatedRectangles, tiles) };
+        std::pmr::vector<std::size_t> probeOrder(n, resource);
+        std::iota(probeOrder.begin(), probeOrder.end(), 0);
+        std::sort(probeOrder.begin(), probeOrder.end(), [&contrasts](std::size_t a, std::size_t b) { return contrasts[a] > contrasts[b]; });
+        std::optional<cv::Point2f> upright{}; // direction in the frame of the x axis of upright tiles
+        std::pmr::vector<bool> recognized(n, false, resource);
+        for (std::size_t p = 0; p < std::min<std::size_t>(2, n) && !upright; ++p) {
+            const std::size_t i{ probeOrder[p] };
+            const cv::RotatedRect& rect = rotatedRectangles[tiles[i]];
+            std::optional<LetterGuess> guess{ axis ? recognizeLetter(tileImages[i], alignedQuarterTurns(rect, *axis), verbose) : recognizeLetter(tileImages[i], allQuarterTurns, verbose) };
+            if (guess) {
+                letters[i] = guess->letter;
+                upright = readingDirection(rect, guess->quarterTurns);
+            }
+            recognized[i] = guess || !axis; // retry tiles which were only read in two orientations
+        }
 
-        for (int i = 0; i < 4; ++i) {
-            cv::rotate(preprocessedImage, preprocessedImage, cv::ROTATE_90_CLOCKWISE);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (recognized[i]) continue;
+            const cv::RotatedRect& rect = rotatedRectangles[tiles[i]];
+            std::optional<LetterGuess> guess{ upright ? recognizeLetter(tileImages[i], std::array<int, 1>{ closestQuarterTurns(rect, *upright) }, verbose)
+                : recognizeLetter(tileImages[i], allQuarterTurns, verbose) };
+            if (guess) letters[i] = guess->letter;
+        }
+    }
+
+    /**
+     * @brief Recognizes a single character on a preprocessed tile.
+     *
+     * @param preprocessedImage The tile, as returned by preprocessImage.
+     * @param quarterTurnsToTry Orientations to try, as clockwise quarter turns of the tile.
+     * @param verbose If true adds extra debugging information.
+     * @return The most confident letter and its orientation, if it is confident enough.
+     */
+    std::optional<LetterGuess> recognizeLetter(const cv::Mat& preprocessedImage, std::span<const int> quarterTurnsToTry, bool verbose) {
+        std::optional<LetterGuess> bestGuess = std::nullopt;
+
+        for (int quarterTurns : quarterTurnsToTry) {
+            cv::Mat rotatedImage{ rotateQuarterTurns(preprocessedImage, quarterTurns) };
 
             // Perform OCR
-            tess.SetImage(preprocessedImage.data, preprocessedImage.cols, preprocessedImage.rows, 1, preprocessedImage.step);
+            tess.SetImage(rotatedImage.data, rotatedImage.cols, rotatedImage.rows, 1, rotatedImage.step);
             char* text = tess.GetUTF8Text();
             int* confidences = tess.AllWordConfidences();
 
             // Ensure text has two characters - the letter and \n
             if (text != nullptr && confidences != nullptr && std::strlen(text) == 2) {
-                if (confidences[0] > bestGuessConfidence) {
-                    bestGuessConfidence = confidences[0];
-                    bestGuess = text[0]; // Store the best recognized character
+                if (!bestGuess || confidences[0] > bestGuess->confidence) {
+                    bestGuess = LetterGuess{ text[0], confidences[0], quarterTurns }; // Store the best recognized character
                 }
             }
 
-            if (verbose) displayTile(preprocessedImage, text, confidences ? confidences[0] : 0);
+            if (verbose) displayTile(rotatedImage, text, confidences ? confidences[0] : 0);
 
+            delete[] text;
+            delete[] confidences;
             tess.Clear();
         }
 
-        if ((bestGuess) && (bestGuessConfidence > CONFIDENCE_THRESHOLD)) {
-            if (verbose) std::cout << "Best guess: " << *bestGuess << " (Confidence: " << bestGuessConfidence << ")" << std::endl;
+        if ((bestGuess) && (bestGuess->confidence > CONFIDENCE_THRESHOLD)) {
+            if (verbose) std::cout << "Best guess: " << bestGuess->letter << " (Confidence: " << bestGuess->confidence << ")" << std::endl;
             return bestGuess;
         }
 
         return std::nullopt;
     }
 
+    /**
+     * @brief Direction of the line the tiles of a word lie along.
+     *
+     * @param rotatedRectangles Represents the location of the tiles within the frame.
+     * @param tiles Indices into rotatedRectangles of the tiles in the word.
+     * @return Unit vector along the principal axis of the tile centres, or nullopt if they do not lie along a line.
+     */
+    static std::optional<cv::Point2f> principalAxis(const std::vector<cv::RotatedRect>& rotatedRectangles, std::span<const std::size_t> tiles) {
+        if (std::size(tiles) < 2) return std::nullopt;
+        cv::Point2f mean{ 0, 0 };
+        for (std::size_t i : tiles) mean += rotatedRectangles[i].center;
+        mean *= 1.0f / static_cast<float>(std::size(tiles));
+        double xx{ 0 }, xy{ 0 }, yy{ 0 };
+        for (std::size_t i : tiles) {
+            const cv::Point2f d{ rotatedRectangles[i].center - mean };
+            xx += d.x * d.x;
+            xy += d.x * d.y;
+            yy += d.y * d.y;
+        }
+        // Eigenvalues of the covariance matrix
+        const double halfTrace{ (xx + yy) / 2 };
+        const double discriminant{ std::sqrt(std::max(0.0, halfTrace * halfTrace - (xx * yy - xy * xy))) };
+        const double major{ halfTrace + discriminant };
+        const double minor{ halfTrace - discriminant };
+        if (major <= 0 || minor > 0.1 * major) return std::nullopt;
+        const double angle{ 0.5 * std::atan2(2 * xy, xx - yy) };
+        return cv::Point2f(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+
+    /**
+     * @brief The two orientations of a tile which read along an axis, in either direction.
+     */
+    static std::array<int, 2> alignedQuarterTurns(const cv::RotatedRect& rotatedRect, const cv::Point2f& axis) {
+        if (std::abs(readingDirection(rotatedRect, 0).dot(axis)) >= std::abs(readingDirection(rotatedRect, 1).dot(axis))) {
+            return { 0, 2 };
+        }
+        return { 1, 3 };
+    }
+
+    /**
+     * @brief The orientation of a tile which reads closest to a direction in the frame.
+     */
+    static int closestQuarterTurns(const cv::RotatedRect& rotatedRect, const cv::Point2f& direction) {
+        int bestQuarterTurns{ 0 };
+        for (int quarterTurns = 1; quarterTurns < 4; ++quarterTurns) {
+            if (readingDirection(rotatedRect, quarterTurns).dot(direction) > readingDirection(rotatedRect, bestQuarterTurns).dot(direction)) {
+                bestQuarterTurns = quarterTurns;
+            }
+        }
+        return bestQuarterTurns;
+    }
+
+    /**
+     * @brief Standard deviation of the grey levels around a tile, used to pick tiles which are easiest to read.
+     */
+    static double tileContrast(const cv::Mat& frame, const cv::RotatedRect& rotatedRect) {
+        const cv::Rect roi{ rotatedRect.boundingRect() & cv::Rect(0, 0, frame.cols, frame.rows) };
+        if (roi.empty()) return 0;
+        cv::Mat gray;
+        if (frame.channels() == 1) gray = frame(roi);
+        else cv::cvtColor(frame(roi), gray, cv::COLOR_BGR2GRAY);
+        cv::Scalar mean, stddev;
+        cv::meanStdDev(gray, mean, stddev);
+        return stddev[0];
+    }
+
+    /**
+     * @brief Groups tiles which are adjacent to each other, i.e. which form a word.
+     *
+     * @param rotatedRectangles Represents the location of the tiles within the frame.
+     * @param resource Memory resource for the groups and the search.
+     * @return Indices into rotatedRectangles of the tiles in each group.
+     */
+    static std::pmr::vector<std::pmr::vector<std::size_t>> groupAdjacentTiles(const std::vector<cv::RotatedRect>& rotatedRectangles, std::pmr::memory_resource* resource) {
+        // The same adjacency and grid as the letter node graph
+        std::pmr::vector<LetterNode> tiles{ resource };
+        tiles.reserve(std::size(rotatedRectangles));
+        for (const cv::RotatedRect& rotatedRect : rotatedRectangles) tiles.push_back(LetterNode{ '\0', rotatedRect });
+        return LetterNodeUtils::groupConnectedNodes(tiles, LetterNodeUtils::pitchAdjacencyStrategy, LetterNodeUtils::pitchAdjacencyCellSize(tiles), resource);
+    }
+
+    /**
+     * @brief Recognizes a group of adjacent tiles as one word.
+     *
+     * The tiles are laid out as a single strip in the two orientations which read along
+     * the word's principal axis, and the orientation whose word OCR best covers the tiles
+     * is kept. Groups which do not lie along a line, e.g. crossing words, are left to
+     * recognizeComponent without any word OCR.
+     *
+     * @param frame The raw frame from the video camera.
+     * @param rotatedRectangles Represents the location of the tiles within the frame.
+     * @param component Indices into rotatedRectangles of the tiles in the group.
+     * @param bestLetters Receives the letter on each tile of the group, or nullopt where the strip was inconsistent.
+     * @param verbose If true adds extra debugging information.
+     */
+    void recognizeStrip(const cv::Mat& frame, const std::vector<cv::RotatedRect>& rotatedRectangles, std::span<const std::size_t> component,
+        std::span<std::optional<char>> bestLetters, bool verbose) {
+        std::fill(bestLetters.begin(), bestLetters.end(), std::nullopt);
+        std::optional<cv::Point2f> axis{ principalAxis(rotatedRectangles, component) };
+        if (!axis) return;
+
+        std::vector<cv::Mat> tileImages{};
+        for (std::size_t i : component) {
+            tileImages.push_back(preprocessImage(frame, rotatedRectangles[i]));
+        }
+
+        double bestScore{ 0 };
+        for (int quarterTurns : alignedQuarterTurns(rotatedRectangles[component.front()], *axis)) {
+            double score{ 0 };
+            std::vector<std::optional<char>> letters{ readStrip(tileImages, rotatedRectangles, component, quarterTurns, score, verbose) };
+            if (score > bestScore) {
+                bestScore = score;
+                std::copy(letters.begin(), letters.end(), bestLetters.begin());
+            }
+        }
+    }
+
+    /**
+     * @brief Lays out the tiles of a group as one strip in a given orientation and runs word OCR on it.
+     *
+     * @param tileImages The preprocessed image of each tile in the group.
+     * @param rotatedRectangles Represents the location of the tiles within the frame.
+     * @param component Indices into rotatedRectangles of the tiles in the group.
+     * @param quarterTurns Number of clockwise quarter turns applied to every tile.
+     * @param score Set to the mean confidence over all tiles, counting inconsistent tiles as zero.
+     * @param verbose If true adds extra debugging information.
+     * @return The letter on each tile of the group, or nullopt where the strip was inconsistent.
+     */
+    std::vector<std::optional<char>> readStrip(const std::vector<cv::Mat>& tileImages, const std::vector<cv::RotatedRect>& rotatedRectangles,
+        std::span<const std::size_t> component, int quarterTurns, double& score, bool verbose) {
+        const std::size_t n{ std::size(component) };
+
+        // Read the tiles in order along the direction their rotated x axis now points
+        std::vector<std::size_t> order(n);
+        std::vector<float> positions(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const cv::RotatedRect& rect = rotatedRectangles[component[i]];
+            positions[i] = rect.center.dot(readingDirection(rect, quarterTurns));
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&positions](std::size_t a, std::size_t b) { return positions[a] < positions[b]; });
+
+        // Scale every tile to a common height and place them side by side on a white strip
+        std::vector<cv::Mat> rotatedTiles(n);
+        int height{ 0 };
+        for (std::size_t i = 0; i < n; ++i) {
+            rotatedTiles[i] = rotateQuarterTurns(tileImages[i], quarterTurns);
+            height = std::max(height, rotatedTiles[i].rows);
+        }
+        const int gap{ std::max(1, height / 4) };
+        int width{ gap };
+        for (cv::Mat& tile : rotatedTiles) {
+            cv::resize(tile, tile, cv::Size(std::max(1, cvRound(tile.cols * height / static_cast<double>(tile.rows))), height), 0, 0, cv::INTER_CUBIC);
+            width += tile.cols + gap;
+        }
+        cv::Mat strip(height + 2 * gap, width, CV_8UC1, cv::Scalar(255));
+        std::vector<std::pair<int, int>> slots(n); // horizontal extent of each tile in the strip
+        int x{ gap };
+        for (std::size_t i : order) {
+            rotatedTiles[i].copyTo(strip(cv::Rect(x, gap, rotatedTiles[i].cols, rotatedTiles[i].rows)));
+            slots[i] = { x, x + rotatedTiles[i].cols };
+            x += rotatedTiles[i].cols + gap;
+        }
+
+        // Perform OCR, assigning each recognized symbol to the tile under its centre
+        std::vector<std::optional<char>> letters(n);
+        std::vector<float> confidences(n, 0.0f);
+        std::vector<int> symbolCounts(n, 0);
+        std::string text{};
+        tess.SetPageSegMode(tesseract::PSM_SINGLE_WORD);
+        tess.SetImage(strip.data, strip.cols, strip.rows, 1, strip.step);
+        if (tess.Recognize(nullptr) == 0) {
+            std::unique_ptr<tesseract::ResultIterator> iterator{ tess.GetIterator() };
+            if (iterator) {
+                do {
+                    std::unique_ptr<char[]> symbol{ iterator->GetUTF8Text(tesseract::RIL_SYMBOL) };
+                    int left, top, right, bottom;
+                    if (!symbol || !iterator->BoundingBox(tesseract::RIL_SYMBOL, &left, &top, &right, &bottom)) continue;
+                    text += symbol.get();
+                    const int centre{ (left + right) / 2 };
+                    for (std::size_t i = 0; i < n; ++i) {
+                        if (centre >= slots[i].first && centre < slots[i].second) {
+                            ++symbolCounts[i];
+                            letters[i] = symbol[0];
+                            confidences[i] = iterator->Confidence(tesseract::RIL_SYMBOL);
+                        }
+                    }
+                } while (iterator->Next(tesseract::RIL_SYMBOL));
+            }
+        }
+        tess.Clear();
+        tess.SetPageSegMode(tesseract::PSM_SINGLE_CHAR);
+
+        // A tile is consistent if exactly one confident symbol landed on it
+        score = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (symbolCounts[i] != 1 || confidences[i] <= CONFIDENCE_THRESHOLD) {
+                letters[i] = std::nullopt;
+                continue;
+            }
+            score += confidences[i];
+        }
+        score /= n;
+
+        if (verbose) displayTile(strip, text.c_str(), static_cast<int>(score));
+        return letters;
+    }
+
+    /**
+     * @brief Rotates an image clockwise by a number of quarter turns.
+     */
+    static cv::Mat rotateQuarterTurns(const cv::Mat& image, int quarterTurns) {
+        cv::Mat rotatedImage;
+        switch (quarterTurns % 4) {
+        case 1: cv::rotate(image, rotatedImage, cv::ROTATE_90_CLOCKWISE); break;
+        case 2: cv::rotate(image, rotatedImage, cv::ROTATE_180); break;
+        case 3: cv::rotate(image, rotatedImage, cv::ROTATE_90_COUNTERCLOCKWISE); break;
+        default: rotatedImage = image.clone(); break;
+        }
+        return rotatedImage;
+    }
+
+    /**
+     * @brief Direction in the frame of a tile's x axis after it is cropped and rotated.
+     *
+     * preprocessImage crops tiles so that their x axis points along (cos a, sin a) in the
+     * frame. Each clockwise quarter turn maps the new x axis onto the old negative y axis.
+     *
+     * @param rotatedRect The rotated rectangle containing the tile.
+     * @param quarterTurns Number of clockwise quarter turns applied to the cropped tile.
+     * @return Unit vector in frame coordinates.
+     */
+    static cv::Point2f readingDirection(const cv::RotatedRect& rotatedRect, int quarterTurns) {
+        const double angle{ rotatedRect.angle * CV_PI / 180.0 };
+        cv::Point2f xAxis(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+        cv::Point2f yAxis(-xAxis.y, xAxis.x);
+        for (int i = 0; i < quarterTurns % 4; ++i) {
+            cv::Point2f newXAxis{ -yAxis };
+            yAxis = xAxis;
+            xAxis = newXAxis;
+        }
+        return xAxis;
+    }
+
     /**
      * @brief Preprocesses an image for text recognition.
      * 
@@ -168,35 +686,103 @@ private:
      */
     cv::Mat preprocessImage(const cv::Mat& frame, const cv::RotatedRect& rotatedRect) const {
         cv::Mat preprocessedImage;
-        
+
+        cv::Mat grayImage{ cropTile(frame, rotatedRect) };
+        if (std::max(rotatedRect.size.width, rotatedRect.size.height) < smallTileLengthPixels && !recentFrames.empty()) {
+            grayImage = fuseTileCrops(grayImage, frame.size(), rotatedRect);
+        }
+
+        // Blur
+        cv::Mat blurredImage;
+        cv::GaussianBlur(grayImage, blurredImage, cv::Size(5, 5), 0);
+
+        // Threshold
+        cv::threshold(blurredImage, preprocessedImage, 150, 255, cv::THRESH_BINARY);
+
+        return preprocessedImage;
+    }
+
+    /**
+     * @brief Crops a tile upright from a frame and scales it to the OCR resolution.
+     *
+     * @param frame The raw frame from the video.
+     * @param rotatedRect The rotated rectangle containing the tile.
+     * @return Grayscale image of the tile.
+     */
+    cv::Mat cropTile(const cv::Mat& frame, const cv::RotatedRect& rotatedRect) const {
+        // Take the region around the tile so that only it is rotated
+        const cv::Rect frameRect(0, 0, frame.cols, frame.rows);
+        const cv::Rect boundingRect{ rotatedRect.boundingRect() };
+        cv::Rect region{ cv::Rect(boundingRect.x - tileRegionMargin, boundingRect.y - tileRegionMargin,
+            boundingRect.width + 2 * tileRegionMargin, boundingRect.height + 2 * tileRegionMargin) & frameRect };
+        if (region.empty()) region = frameRect;
+        const cv::Point2f center{ rotatedRect.center - cv::Point2f(region.tl()) };
+
         // Rotate the image
         cv::Mat rotatedImage;
-        cv::Mat rotationMatrix = cv::getRotationMatrix2D(rotatedRect.center, rotatedRect.angle, 1.0);
-        cv::warpAffine(frame, rotatedImage, rotationMatrix, frame.size(), cv::INTER_CUBIC);
+        cv::Mat rotationMatrix = cv::getRotationMatrix2D(center, rotatedRect.angle, 1.0);
+        cv::warpAffine(frame(region), rotatedImage, rotationMatrix, region.size(), cv::INTER_CUBIC);
 
         // Crop the image
         cv::Mat croppedImage;
-        cv::getRectSubPix(rotatedImage, rotatedRect.size, rotatedRect.center, croppedImage);
+        cv::getRectSubPix(rotatedImage, rotatedRect.size, center, croppedImage);
 
-        // Resize
+        // Convert to grayscale, unless the frame is already luma
+        cv::Mat grayImage;
+        if (croppedImage.channels() == 3) cv::cvtColor(croppedImage, grayImage, cv::COLOR_BGR2GRAY);
+        else grayImage = croppedImage;
+
+        // Resize, to the same scale for every tile once the tile size is known
         cv::Mat resizedImage;
-        const double tileLengthPixels{ rotatedRect.size.width };
+        const double tileLengthPixels{ tilePitchEstimator->getTileSize().value_or(rotatedRect.size.width) };
         const double tileDpi{ tileLengthPixels / tileLengthInches };
         const double scaleFactor{ userDefinedDpi / tileDpi };
-        cv::resize(croppedImage, resizedImage, cv::Size(), scaleFactor, scaleFactor, cv::INTER_CUBIC);
-
-        // Convert to grayscale
-        cv::Mat grayImage;
-        cv::cvtColor(resizedImage, grayImage, cv::COLOR_BGR2GRAY);
+        cv::resize(grayImage, resizedImage, cv::Size(), scaleFactor, scaleFactor, cv::INTER_CUBIC);
 
-        // Blur
-        cv::Mat blurredImage;
-        cv::GaussianBlur(grayImage, blurredImage, cv::Size(5, 5), 0);
+        return resizedImage;
+    }
 
-        // Threshold
-        cv::threshold(blurredImage, preprocessedImage, 150, 255, cv::THRESH_BINARY);
+    /**
+     * @brief Averages the crops of a tile from the recent frames.
+     *
+     * Each crop is registered to the reference crop with phase correlation. Crops which
+     * do not correlate, e.g. because the tile was moved or covered by a hand, are skipped.
+     *
+     * @param referenceCrop Grayscale crop of the tile from the processed frame.
+     * @param frameSize Size of the processed frame; recent frames of another size are skipped.
+     * @param rotatedRect The rotated rectangle containing the tile.
+     * @return Grayscale image of the tile, the same size as referenceCrop.
+     */
+    cv::Mat fuseTileCrops(const cv::Mat& referenceCrop, const cv::Size& frameSize, const cv::RotatedRect& rotatedRect) const {
+        cv::Mat reference;
+        referenceCrop.convertTo(reference, CV_32F);
+        cv::Mat window;
+        cv::createHanningWindow(window, reference.size(), CV_32F);
+        const double maxShift{ reference.cols / 4.0 };
+
+        cv::Mat sum{ reference.clone() };
+        int count{ 1 };
+        for (const cv::Mat& recentFrame : recentFrames) {
+            if (recentFrame.size() != frameSize) continue;
+            cv::Mat crop;
+            cropTile(recentFrame, rotatedRect).convertTo(crop, CV_32F);
+            if (crop.size() != reference.size()) continue;
+
+            double response{ 0 };
+            const cv::Point2d shift{ cv::phaseCorrelate(reference, crop, window, &response) };
+            if (response < minRegistrationResponse || std::hypot(shift.x, shift.y) > maxShift) continue;
+
+            // Shift the crop back onto the reference
+            cv::Mat translation = (cv::Mat_<double>(2, 3) << 1, 0, -shift.x, 0, 1, -shift.y);
+            cv::Mat aligned;
+            cv::warpAffine(crop, aligned, translation, crop.size(), cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+            sum += aligned;
+            ++count;
+        }
 
-        return preprocessedImage;
+        cv::Mat fusedImage;
+        sum.convertTo(fusedImage, CV_8U, 1.0 / count);
+        return fusedImage;
     }
 
     /**
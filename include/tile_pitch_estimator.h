@@ -0,0 +1,131 @@
+/**
+ * @file tile_pitch_estimator.h
+ * @brief Header file for the TilePitchEstimator class.
+ *
+ * This file contains the declaration of the TilePitchEstimator class, which
+ * estimates the size of the tiles from the tiles detected during a session.
+ * Tiles are grouped into words by their own sizes rather than by an estimated
+ * pitch, so the spacing of the tiles is not estimated.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef TILE_PITCH_ESTIMATOR_H
+#define TILE_PITCH_ESTIMATOR_H
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class TilePitchEstimator
+ * @brief Robust online estimate of the tile size.
+ *
+ * Keeps the most recent samples of the tile side length and reports their median,
+ * so a few bad detections do not move the estimate. The session wide estimate shared by the
+ * detector and the recognizer is accessed through getInstance().
+ * All lengths are in full resolution pixels.
+ */
+class TilePitchEstimator {
+public:
+    /**
+     * @brief Provides access to the session wide estimator.
+     *
+     * @return Reference to the session wide estimator.
+     */
+    static TilePitchEstimator& getInstance() {
+        static TilePitchEstimator instance;
+        return instance;
+    }
+
+    /**
+     * @brief Creates an estimator without any samples.
+     *
+     * @param windowSize Number of most recent samples the medians are taken over.
+     */
+    explicit TilePitchEstimator(std::size_t windowSize = 256) : windowSize(windowSize) {}
+
+    TilePitchEstimator(const TilePitchEstimator&) = delete;
+    TilePitchEstimator& operator=(const TilePitchEstimator&) = delete;
+
+    /**
+     * @brief Adds the tiles detected in a frame.
+     *
+     * @param tiles The detected tiles.
+     * @param scale Full resolution pixels per pixel of the tiles' coordinates.
+     */
+    void update(const std::vector<cv::RotatedRect>& tiles, double scale = 1.0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const cv::RotatedRect& tile : tiles) {
+            addSample(sizeSamples, static_cast<float>(std::sqrt(tile.size.area()) * scale));
+        }
+        tileSize = median(sizeSamples, minSamples);
+    }
+
+    /**
+     * @brief Forgets all samples, e.g. when the camera is moved.
+     */
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        sizeSamples.clear();
+        tileSize.reset();
+    }
+
+    /**
+     * @return The median tile side length, or nullopt until there are enough samples.
+     */
+    std::optional<float> getTileSize() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return tileSize;
+    }
+
+    /**
+     * @brief Checks if a detected region is about the size of a tile.
+     *
+     * The window is wide enough for the tiles nearest to and furthest from a tilted
+     * camera, which can differ in side length by a factor of two.
+     *
+     * @param tile The detected region.
+     * @param scale Full resolution pixels per pixel of the region's coordinates.
+     * @return true if its side length is within a factor of the estimated tile size, or if there is no estimate yet.
+     */
+    bool isPlausibleSize(const cv::RotatedRect& tile, double scale = 1.0) const {
+        std::optional<float> size{ getTileSize() };
+        if (!size) return true;
+        const double side{ std::sqrt(tile.size.area()) * scale };
+        return side > minSideRatio * *size && side < maxSideRatio * *size;
+    }
+
+private:
+    static constexpr std::size_t minSamples{ 8 };
+    static constexpr double minSideRatio{ 0.5 };
+    static constexpr double maxSideRatio{ 2.0 };
+    std::size_t windowSize;
+    std::deque<float> sizeSamples{};
+    std::optional<float> tileSize{};
+    mutable std::mutex mutex;
+
+    /**
+     * @brief Adds a sample, dropping the oldest one if the window is full.
+     */
+    void addSample(std::deque<float>& samples, float sample) {
+        samples.push_back(sample);
+        if (std::size(samples) > windowSize) samples.pop_front();
+    }
+
+    /**
+     * @return Median of the samples, or nullopt if there are fewer than minimumCount.
+     */
+    static std::optional<float> median(const std::deque<float>& samples, std::size_t minimumCount) {
+        if (std::size(samples) < std::max<std::size_t>(minimumCount, 1)) return std::nullopt;
+        std::vector<float> sorted(samples.begin(), samples.end());
+        auto middle = sorted.begin() + std::size(sorted) / 2;
+        std::nth_element(sorted.begin(), middle, sorted.end());
+        return *middle;
+    }
+};
+
+#endif
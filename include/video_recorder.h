@@ -0,0 +1,210 @@
+/**
+ * @file video_recorder.h
+ * @brief Header file for the VideoRecorder class.
+ *
+ * This file contains the declaration of the VideoRecorder class, which encodes
+ * frames to a video file on a thread of its own so that recording a game does
+ * not slow down the pipeline.
+ *
+ * @author Aled Vaghela
+ */
+
+#ifndef VIDEO_RECORDER_H
+#define VIDEO_RECORDER_H
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <condition_variable>
+#include <opencv2/opencv.hpp>
+
+/**
+ * @class VideoRecorder
+ * @brief Records frames through a bounded queue to an encoder thread.
+ *
+ * record() only copies the frame into a free buffer and queues it. When the
+ * encoder falls behind and the queue is full the frame is dropped rather than
+ * blocking the caller, and the number of dropped frames is counted. Buffers
+ * are reused once encoded, so recording frames of the usual size does not allocate.
+ * Frames of another size or number of channels, e.g. the annotated frames
+ * between live frames, are converted to the video's format on the encoder thread.
+ */
+class VideoRecorder {
+public:
+    /**
+     * @brief Writes one frame in the video's format.
+     */
+    using FrameWriter = std::function<void(const cv::Mat&)>;
+
+    /**
+     * @brief Opens a video file and starts the encoder thread.
+     *
+     * @param path Path of the video file; the container is chosen from its extension.
+     * @param fps Frame rate of the video.
+     * @param frameSize Size of the frames in the video.
+     * @param isColor Whether the video is BGR rather than grayscale.
+     * @param queueCapacity Number of frames which may wait to be encoded.
+     * @throw std::runtime_error If the video file cannot be opened.
+     * @throw std::invalid_argument If queueCapacity is 0.
+     */
+    VideoRecorder(const std::string& path, double fps, cv::Size frameSize, bool isColor = true, std::size_t queueCapacity = 32)
+        : frameSize(frameSize), isColor(isColor), queueCapacity(queueCapacity) {
+        if (queueCapacity == 0) { throw std::invalid_argument("VideoRecorder queue capacity must be positive."); }
+        if (!videoWriter.open(path, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), fps, frameSize, isColor)) {
+            throw std::runtime_error("Cannot open video file " + path + " for recording.");
+        }
+        writeFrame = [this](const cv::Mat& frame) { videoWriter.write(frame); };
+        encoder = std::thread(&VideoRecorder::encode, this);
+    }
+
+    /**
+     * @brief Starts the encoder thread with another destination for the frames, e.g. for testing.
+     *
+     * @param writeFrame Called on the encoder thread with each frame in the video's format.
+     * @param frameSize Size of the frames passed to writeFrame.
+     * @param isColor Whether the frames passed to writeFrame are BGR rather than grayscale.
+     * @param queueCapacity Number of frames which may wait to be encoded.
+     * @throw std::invalid_argument If queueCapacity is 0.
+     */
+    VideoRecorder(FrameWriter writeFrame, cv::Size frameSize, bool isColor = true, std::size_t queueCapacity = 32)
+        : writeFrame(std::move(writeFrame)), frameSize(frameSize), isColor(isColor), queueCapacity(queueCapacity) {
+        if (queueCapacity == 0) { throw std::invalid_argument("VideoRecorder queue capacity must be positive."); }
+        encoder = std::thread(&VideoRecorder::encode, this);
+    }
+
+    VideoRecorder(const VideoRecorder&) = delete;
+    VideoRecorder& operator=(const VideoRecorder&) = delete;
+
+    /**
+     * @brief Encodes the frames still queued and closes the video.
+     */
+    ~VideoRecorder() {
+        close();
+    }
+
+    /**
+     * @brief Queues a frame to be encoded, without waiting for the encoder.
+     *
+     * May be called from several threads at once. The frame's place in the queue is
+     * reserved before it is copied, so the queue never holds more than its capacity.
+     *
+     * @param frame The frame to record; it is copied, so it may be reused straight away.
+     * @return false if the queue was full or the recorder closed, and the frame was dropped.
+     */
+    bool record(const cv::Mat& frame) {
+        cv::Mat buffer;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed || std::size(pending) + reservedCount >= queueCapacity) {
+                ++droppedCount;
+                return false;
+            }
+            ++reservedCount;
+            if (!freeBuffers.empty()) {
+                buffer = std::move(freeBuffers.back());
+                freeBuffers.pop_back();
+            }
+        }
+        frame.copyTo(buffer);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --reservedCount;
+            pending.push_back(std::move(buffer));
+        }
+        frameQueued.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Encodes the frames still queued and closes the video; later frames are dropped.
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed) return;
+            closed = true;
+        }
+        frameQueued.notify_one();
+        if (encoder.joinable()) encoder.join();
+        videoWriter.release();
+    }
+
+    /**
+     * @return Number of frames dropped because the encoder could not keep up.
+     */
+    std::size_t getDroppedCount() const {
+        return droppedCount;
+    }
+
+    /**
+     * @return Number of frames written to the video.
+     */
+    std::size_t getWrittenCount() const {
+        return writtenCount;
+    }
+
+private:
+    cv::VideoWriter videoWriter{};
+    FrameWriter writeFrame{};
+    cv::Size frameSize;
+    bool isColor;
+    std::size_t queueCapacity;
+    std::deque<cv::Mat> pending{};
+    std::size_t reservedCount{ 0 }; // frames being copied into the queue
+    std::vector<cv::Mat> freeBuffers{};
+    bool closed{ false };
+    std::atomic<std::size_t> droppedCount{ 0 };
+    std::atomic<std::size_t> writtenCount{ 0 };
+    std::mutex mutex;
+    std::condition_variable frameQueued;
+    std::thread encoder{};
+
+    /**
+     * @brief Encoder thread: writes queued frames until the recorder is closed and the queue is empty.
+     *
+     * Frames which were accepted before the recorder closed but are still being copied are waited for.
+     */
+    void encode() {
+        cv::Mat converted;
+        while (true) {
+            cv::Mat frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                frameQueued.wait(lock, [this]() { return (closed && reservedCount == 0) || !pending.empty(); });
+                if (pending.empty()) return;
+                frame = std::move(pending.front());
+                pending.pop_front();
+            }
+            writeFrame(toVideoFormat(frame, converted));
+            ++writtenCount;
+            std::lock_guard<std::mutex> lock(mutex);
+            freeBuffers.push_back(std::move(frame));
+        }
+    }
+
+    /**
+     * @brief Converts a frame to the size and number of channels of the video.
+     *
+     * @param frame The queued frame.
+     * @param converted Buffer for the conversion.
+     * @return The frame itself if it is already in the video's format, otherwise converted.
+     */
+    const cv::Mat& toVideoFormat(const cv::Mat& frame, cv::Mat& converted) const {
+        const cv::Mat* current = &frame;
+        if ((current->channels() == 1) == isColor) {
+            cv::cvtColor(*current, converted, isColor ? cv::COLOR_GRAY2BGR : cv::COLOR_BGR2GRAY);
+            current = &converted;
+        }
+        if (current->size() != frameSize) {
+            cv::resize(*current, converted, frameSize, 0, 0, cv::INTER_AREA);
+            current = &converted;
+        }
+        return *current;
+    }
+};
+
+#endif
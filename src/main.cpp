@@ -10,35 +10,103 @@
 
 #include <iostream>
 #include <cstring>
+#include <charconv>
 #include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <future>
+#include <memory>
 #include <opencv2/opencv.hpp>
 #include <tesseract/baseapi.h>
 #include "text_detector.h"
 #include "text_recognizer.h"
+#include "frame_ring.h"
+#include "luma_capture.h"
 #include "snatchable_word_generator.h"
+#include "session_analyzer.h"
+#include "multi_camera_board.h"
+#include "startup_timeline.h"
+#include "frame_arena.h"
+#include "video_recorder.h"
+#include "batch_processor.h"
 
 /**
  * @brief Initializes the camera and text processing tools.
  *
+ * The text processing tools are initialized on their own threads while the camera
+ * is opened, and the recognizer is warmed up on a synthetic tile, so the first frame
+ * is processed at full speed. How long each component took is printed.
+ *
  * @param cap Reference to the VideoCapture object.
  * @param window_name Name of the display window.
+ * @param model The tesseract model to load, or empty for the default.
+ * @param recognitionMode How the recognizer reads the tiles.
  * @throw std::runtime_error If cannot initialize.
  */
-void initialize(cv::VideoCapture& cap, const std::string& windowName) {
+void initialize(cv::VideoCapture& cap, const std::string& windowName, const std::string& model, TextRecognizer::RecognitionMode recognitionMode) {
+    StartupTimeline timeline{};
+
+    // initialize text processing tools
+    std::future<void> detector{ std::async(std::launch::async, [&timeline]() {
+        timeline.record("detector", []() { TextDetector::getInstance(); });
+    }) };
+    std::future<void> recognizer{ std::async(std::launch::async, [&timeline, &model, recognitionMode]() {
+        TextRecognizer& textRecognizer = timeline.record("recognizer", []() -> TextRecognizer& { return TextRecognizer::getInstance(); });
+        if (!model.empty()) timeline.record("model " + model, [&]() { textRecognizer.loadModel(model); });
+        textRecognizer.setRecognitionMode(recognitionMode);
+        timeline.record("ocr warm-up", [&]() { textRecognizer.warmUp(); });
+    }) };
+    std::future<void> dictionary{ std::async(std::launch::async, [&timeline]() {
+        timeline.record("dictionary", []() { SnatchableWordGenerator::getInstance(); });
+    }) };
+
     // initialize camera
-    cap.open(0); // default video camera
-    if (!cap.isOpened()) {
+    bool cameraOpened{ timeline.record("camera", [&cap]() { return cap.open(0); }) }; // default video camera
+    if (cameraOpened) {
+        double dWidth = cap.get(cv::CAP_PROP_FRAME_WIDTH);
+        double dHeight = cap.get(cv::CAP_PROP_FRAME_HEIGHT);
+        std::cout << "Resolution of the video: " << dWidth << " x " << dHeight << std::endl;
+        cv::namedWindow(windowName);
+    }
+
+    // rethrows any failure, after every thread has finished
+    std::vector<std::future<void>*> futures{ &detector, &recognizer, &dictionary };
+    std::for_each(futures.begin(), futures.end(), [](std::future<void>* future) { future->wait(); });
+    std::cout << "Startup timeline:\n";
+    timeline.print(std::cout);
+    if (!cameraOpened) {
         throw std::runtime_error("Cannot open camera.");
     }
-    double dWidth = cap.get(cv::CAP_PROP_FRAME_WIDTH);
-    double dHeight = cap.get(cv::CAP_PROP_FRAME_HEIGHT);
-    std::cout << "Resolution of the video: " << dWidth << " x " << dHeight << std::endl;
-    cv::namedWindow(windowName);
+    std::for_each(futures.begin(), futures.end(), [](std::future<void>* future) { future->get(); });
+}
 
-    // initialize text processing tools
-    TextDetector::getInstance();
-    TextRecognizer::getInstance();
-    SnatchableWordGenerator::getInstance(); 
+/**
+ * @brief Recognizes the words on the detected tiles and reports any snatches.
+ *
+ * @param frame The video frame the tiles were detected in.
+ * @param tileLocations The detected tiles.
+ * @param windowName Reference to the main window for OCR results display.
+ * @param verbose Extra debugging information for the text recognition steps.
+ * @param recorder Records the frame with the recognized letters drawn on it, if not nullptr.
+ */
+void processTiles(const cv::Mat& frame, const std::vector<cv::RotatedRect>& tileLocations, const std::string& windowName, bool verbose, VideoRecorder* recorder) {
+    static FrameArena frameArena{}; // transient data of the frame, released once it has been processed
+    TextRecognizer& textRecognizer = TextRecognizer::getInstance();
+    SnatchableWordGenerator& snatchableWordGenerator = SnatchableWordGenerator::getInstance();
+    {
+        std::pmr::vector<std::pmr::string> words = textRecognizer.generateWords(frame, tileLocations, windowName, verbose, frameArena.resource());
+        std::pmr::vector<std::pmr::string> snatchableWords = snatchableWordGenerator.generateSnatchableWords(words, SnatchQuery{},
+            SnatchableWordGenerator::SolveMode::Automatic, frameArena.resource());
+        if (std::size(snatchableWords) > 0) {
+            std::cout << "SNATCH!!!!!!!!!!!!!!!!\n";
+            std::for_each(snatchableWords.begin(), snatchableWords.end(), [](const std::pmr::string& x) { std::cout << x << std::endl; });
+        }
+    }
+    frameArena.reset();
+    if (recorder) recorder->record(textRecognizer.getAnnotatedFrame());
+    std::cout << "...frame processed." << std::endl;
+    std::cout << "Press any button to continue.\n";
+    cv::waitKey(0);
 }
 
 /**
@@ -50,22 +118,84 @@ void initialize(cv::VideoCapture& cap, const std::string& windowName) {
  * @param frame Reference to the video frame to be processed.
  * @param windowName Reference to the main window for OCR results display.
  * @param verbose Extra debugging information for the text recognition steps.
+ * @param recorder Records the annotated frame, if not nullptr.
  */
-void processFrame(cv::Mat& frame, const std::string& windowName, bool verbose) {
+void processFrame(cv::Mat& frame, const std::string& windowName, bool verbose, VideoRecorder* recorder) {
     std::cout << "Processing frame ..." << std::endl;
     TextDetector& textDetector = TextDetector::getInstance();
-    TextRecognizer& textRecognizer = TextRecognizer::getInstance();
-    SnatchableWordGenerator& snatchableWordGenerator = SnatchableWordGenerator::getInstance();
     std::vector<cv::RotatedRect> tileLocations = textDetector.getTileLocations(frame, verbose);
-    std::vector<std::string> words = textRecognizer.generateWords(frame, tileLocations, windowName, verbose);
-    std::vector<std::string> snatchableWords = snatchableWordGenerator.generateSnatchableWords(words);
-    if (std::size(snatchableWords) > 0) {
-        std::cout << "SNATCH!!!!!!!!!!!!!!!!\n";
-        std::for_each(snatchableWords.begin(), snatchableWords.end(), [](std::string x) { std::cout << x << std::endl; });
+    processTiles(frame, tileLocations, windowName, verbose, recorder);
+}
+
+/**
+ * @brief Processes an undecoded frame, detecting on reduced luma and decoding only the tiles.
+ *
+ * @param lumaCapture The capture the frame was read from.
+ * @param rawFrame The undecoded frame.
+ * @param windowName Reference to the main window for OCR results display.
+ * @param verbose Extra debugging information for the text recognition steps.
+ * @param recorder Records the annotated frame, if not nullptr.
+ */
+void processRawFrame(const LumaCapture& lumaCapture, const cv::Mat& rawFrame, const std::string& windowName, bool verbose, VideoRecorder* recorder) {
+    std::cout << "Processing frame ..." << std::endl;
+    TextDetector& textDetector = TextDetector::getInstance();
+    std::vector<cv::RotatedRect> tileLocations = textDetector.getTileLocations(lumaCapture.decodeReducedLuma(rawFrame), LumaCapture::scale, verbose);
+    cv::Mat frame = lumaCapture.decodeTiles(rawFrame, tileLocations);
+    processTiles(frame, tileLocations, windowName, verbose, recorder);
+}
+
+/**
+ * @brief Reports when each play was available in a recorded game, and for how long.
+ *
+ * Every frame is recognised in turn, then the distinct boards are solved in parallel.
+ *
+ * @param path A video file, an image sequence pattern (e.g. frames/%04d.png) or a
+ *             directory of frames; frames in a directory are timestamped by their index.
+ * @param backgroundModel If true the detector's background model is updated with every frame.
+ * @return 0 on successful execution, -1 on failure.
+ */
+int analyzeRecording(const std::string& path, bool backgroundModel) {
+    TextDetector& textDetector = TextDetector::getInstance();
+    TextRecognizer& textRecognizer = TextRecognizer::getInstance();
+    std::vector<BoardObservation> observations{};
+    auto observe = [&](const cv::Mat& frame, double timestamp) {
+        if (backgroundModel) textDetector.updateBackground(frame);
+        std::vector<cv::RotatedRect> tileLocations = textDetector.getTileLocations(frame, false);
+        observations.push_back(BoardObservation{ timestamp, textRecognizer.generateWords(frame, tileLocations) });
+    };
+
+    std::cout << "Recognising boards in " << path << " ..." << std::endl;
+    if (std::filesystem::is_directory(path)) {
+        std::vector<std::filesystem::path> framePaths{};
+        for (const auto& entry : std::filesystem::directory_iterator(path)) {
+            if (entry.is_regular_file()) framePaths.push_back(entry.path());
+        }
+        std::sort(framePaths.begin(), framePaths.end());
+        for (std::size_t i = 0; i < std::size(framePaths); ++i) {
+            cv::Mat frame = cv::imread(framePaths[i].string());
+            if (frame.empty()) continue; // not an image
+            observe(frame, static_cast<double>(i));
+        }
     }
-    std::cout << "...frame processed." << std::endl;
-    std::cout << "Press any button to continue.\n";
-    cv::waitKey(0);
+    else {
+        cv::VideoCapture video(path);
+        if (!video.isOpened()) {
+            std::cerr << "Cannot open recording " << path << std::endl;
+            return -1;
+        }
+        cv::Mat frame;
+        while (video.read(frame)) {
+            observe(frame, video.get(cv::CAP_PROP_POS_MSEC) / 1000.0);
+        }
+    }
+
+    std::cout << "Solving " << std::size(observations) << " boards ..." << std::endl;
+    std::vector<AvailabilityWindow> windows{ SessionAnalyzer::findAvailabilityWindows(observations) };
+    for (const AvailabilityWindow& window : windows) {
+        std::cout << window.word << ": available from " << window.start << " to " << window.end
+            << " (" << window.end - window.start << " unclaimed)" << std::endl;
+    }
+    return 0;
 }
 
 /**
@@ -78,6 +208,71 @@ void displayButtonOptions() {
     std::cout << "=============================\n";
 }
 
+/**
+ * @brief Runs the game over several cameras which together cover the table.
+ *
+ * @param calibrationPath Calibration file with the camera indices and homographies.
+ * @param model The tesseract model each camera loads, or empty for the default.
+ * @param recognitionMode How each camera's recognizer reads the tiles.
+ * @param backgroundModel If true each camera detects tiles against a model of its view of the empty table.
+ * @return 0 on successful execution, -1 on failure.
+ * @throw std::runtime_error If the cameras or text processing tools cannot be initialized.
+ */
+int runMultiCamera(const std::string& calibrationPath, const std::string& model, TextRecognizer::RecognitionMode recognitionMode, bool backgroundModel) {
+    std::vector<CameraCalibration> calibrations{ MultiCameraBoard::loadCalibration(calibrationPath) };
+    std::vector<cv::VideoCapture> caps(std::size(calibrations));
+    std::vector<cv::Mat> homographies{};
+    for (std::size_t i = 0; i < std::size(calibrations); ++i) {
+        caps[i].open(calibrations[i].index);
+        if (!caps[i].isOpened()) {
+            throw std::runtime_error("Cannot open camera " + std::to_string(calibrations[i].index) + ".");
+        }
+        homographies.push_back(calibrations[i].homography);
+    }
+    MultiCameraBoard board{ homographies };
+    if (!model.empty()) board.setModel(model);
+    board.setRecognitionMode(recognitionMode);
+    if (backgroundModel) board.setDetectionMode(TextDetector::DetectionMode::BackgroundModel);
+    board.warmUp();
+    SnatchableWordGenerator& snatchableWordGenerator = SnatchableWordGenerator::getInstance();
+
+    displayButtonOptions();
+    while (true) {
+        std::vector<cv::Mat> frames(std::size(caps));
+        for (std::size_t i = 0; i < std::size(caps); ++i) {
+            if (!caps[i].read(frames[i])) {
+                std::cerr << "Video camera " << calibrations[i].index << " is disconnected" << std::endl;
+                return -1;
+            }
+            cv::imshow("Camera " + std::to_string(calibrations[i].index), frames[i]);
+        }
+        if (backgroundModel) board.updateBackground(frames);
+        int key = cv::waitKey(10); // wait for 10 ms until a key is pressed
+
+        switch (key) {
+        case 13: { // Enter key
+            std::cout << "Processing frames ..." << std::endl;
+            std::vector<std::string> words{ board.generateWords(frames) };
+            std::cout << "Words:\n";
+            std::for_each(words.begin(), words.end(), [](std::string x) { std::cout << x << std::endl; });
+            std::vector<std::string> snatchableWords = snatchableWordGenerator.generateSnatchableWords(words);
+            if (std::size(snatchableWords) > 0) {
+                std::cout << "SNATCH!!!!!!!!!!!!!!!!\n";
+                std::for_each(snatchableWords.begin(), snatchableWords.end(), [](std::string x) { std::cout << x << std::endl; });
+            }
+            std::cout << "...frames processed." << std::endl;
+            displayButtonOptions();
+            break;
+        }
+        case 27: // Escape key
+            std::cout << "Esc key is pressed by user. Stopping the video." << std::endl;
+            return 0;
+        default:
+            continue;
+        }
+    }
+}
+
 /**
  * @brief Main function to run the real-time text detection and recognition application.
  *
@@ -91,41 +286,170 @@ int main(int argc, char* argv[]) {
     cv::VideoCapture cap;
     std::string windowName = "My Camera Feed";
     bool verbose = false; // debug info for the intermediate steps of text recognition
+    std::string recordingPath{}; // analyse a recorded game instead of the live camera
+    bool backgroundModel = false; // detect tiles against a model of the empty table
+    std::optional<LumaCapture::StreamFormat> lumaFormat{}; // read undecoded frames in this format
+    std::string calibrationPath{}; // combine several cameras calibrated to the table
+    std::string model{}; // tesseract model to use instead of eng
+    TextRecognizer::RecognitionMode recognitionMode{ TextRecognizer::RecognitionMode::PerTile };
+    std::string recordPath{}; // record the camera feed and the processed frames to this video file
+    std::string batchInput{}; // analyse every recorded game in this directory
+    std::string batchOutput{}; // directory for the result log of each game
+    unsigned numWorkers{ 0 }; // batch workers, one per core if 0
 
-    // Check for "--verbose" flag
+    // Check for "--verbose", "--whole-word", "--background-model", "--luma <format>", "--cameras <calibration>", "--model <name>", "--record <video>", "--analyze <recording>", "--batch <videos> <logs>" and "--workers <n>" flags
     for (int i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "--verbose") == 0) {
             verbose = true;
         }
+        else if (strcmp(argv[i], "--whole-word") == 0) {
+            recognitionMode = TextRecognizer::RecognitionMode::WholeWord;
+        }
+        else if (strcmp(argv[i], "--background-model") == 0) {
+            backgroundModel = true;
+        }
+        else if (strcmp(argv[i], "--luma") == 0 && i + 1 < argc) {
+            ++i;
+            if (strcmp(argv[i], "yuyv") == 0) lumaFormat = LumaCapture::StreamFormat::Yuyv;
+            else if (strcmp(argv[i], "nv12") == 0) lumaFormat = LumaCapture::StreamFormat::Nv12;
+            else if (strcmp(argv[i], "mjpeg") == 0) lumaFormat = LumaCapture::StreamFormat::Mjpeg;
+            else {
+                std::cerr << "Unknown stream format " << argv[i] << ", expected yuyv, nv12 or mjpeg" << std::endl;
+                return -1;
+            }
+        }
+        else if (strcmp(argv[i], "--cameras") == 0 && i + 1 < argc) {
+            calibrationPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--model") == 0 && i + 1 < argc) {
+            model = argv[++i];
+        }
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--analyze") == 0 && i + 1 < argc) {
+            recordingPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--batch") == 0 && i + 2 < argc) {
+            batchInput = argv[++i];
+            batchOutput = argv[++i];
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            ++i;
+            const char* end{ argv[i] + std::strlen(argv[i]) };
+            auto [parsedEnd, error] = std::from_chars(argv[i], end, numWorkers);
+            if (error != std::errc{} || parsedEnd != end) {
+                std::cerr << "Invalid number of workers " << argv[i] << ", expected a whole number" << std::endl;
+                return -1;
+            }
+        }
+    }
+
+    if (!batchInput.empty()) {
+        try {
+            BatchProcessor batchProcessor{ batchOutput, numWorkers };
+            if (backgroundModel) batchProcessor.setDetectionMode(TextDetector::DetectionMode::BackgroundModel);
+            batchProcessor.setRecognitionMode(recognitionMode);
+            batchProcessor.setModel(model);
+            return batchProcessor.run(batchInput) == 0 ? 0 : -1;
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
     }
 
+    if (!recordingPath.empty()) {
+        try {
+            TextRecognizer::getInstance().setRecognitionMode(recognitionMode);
+            if (!model.empty()) TextRecognizer::getInstance().loadModel(model);
+            if (backgroundModel) TextDetector::getInstance().setDetectionMode(TextDetector::DetectionMode::BackgroundModel);
+            return analyzeRecording(recordingPath, backgroundModel);
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    if (!calibrationPath.empty()) {
+        if (!recordPath.empty() || lumaFormat) {
+            std::cerr << "--record and --luma cannot be used with --cameras" << std::endl;
+            return -1;
+        }
+        try {
+            return runMultiCamera(calibrationPath, model, recognitionMode, backgroundModel);
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    std::optional<LumaCapture> lumaCapture{};
     try {
-        initialize(cap, windowName);
+        initialize(cap, windowName, model, recognitionMode);
+        if (backgroundModel) TextDetector::getInstance().setDetectionMode(TextDetector::DetectionMode::BackgroundModel);
+        if (lumaFormat) lumaCapture.emplace(cap, *lumaFormat);
     }
     catch (const std::runtime_error& e) {
         std::cerr << e.what() << std::endl;
         return -1;
     }
     displayButtonOptions();
+    FrameRing frameRing{}; // recent frames, so a blurred last frame is not processed
+    std::unique_ptr<VideoRecorder> recorder{}; // opened once the size of the displayed frames is known
     while (true) {
-        cv::Mat frame;
-        bool bSuccess = cap.read(frame);
+        cv::Mat frame; // undecoded when reading luma
+        bool bSuccess = lumaCapture ? lumaCapture->read(frame) : cap.read(frame);
 
         if (!bSuccess) {
             std::cerr << "Video camera is disconnected" << std::endl;
             return -1;
         }
 
-        cv::imshow(windowName, frame);
+        cv::Mat displayFrame{ frame };
+        if (lumaCapture) {
+            displayFrame = lumaCapture->decodeReducedLuma(frame);
+            if (displayFrame.empty()) continue; // corrupt frame
+            frameRing.push(frame, FrameRing::sharpness(displayFrame));
+        }
+        else {
+            frameRing.push(frame);
+        }
+        if (backgroundModel) TextDetector::getInstance().updateBackground(displayFrame);
+        if (!recordPath.empty() && !recorder) {
+            const double fps{ cap.get(cv::CAP_PROP_FPS) };
+            try {
+                recorder = std::make_unique<VideoRecorder>(recordPath, fps > 0 ? fps : 30.0, displayFrame.size(), displayFrame.channels() == 3);
+            }
+            catch (const std::runtime_error& e) {
+                std::cerr << e.what() << std::endl;
+                return -1;
+            }
+        }
+        if (recorder) recorder->record(displayFrame);
+        cv::imshow(windowName, displayFrame);
         int key = cv::waitKey(10); // wait for 10 ms until a key is pressed
 
         switch (key) {
         case 13: // Enter key
-            processFrame(frame, windowName, verbose);
+            frame = frameRing.getSharpest().clone();
+            if (lumaCapture) {
+                processRawFrame(*lumaCapture, frame, windowName, verbose, recorder.get());
+            }
+            else {
+                TextRecognizer::getInstance().setRecentFrames(frameRing.getFramesExceptSharpest()); // fused with the processed frame for small tiles
+                processFrame(frame, windowName, verbose, recorder.get());
+            }
             displayButtonOptions();
             break;
         case 27: // Escape key
             std::cout << "Esc key is pressed by user. Stopping the video." << std::endl;
+            if (recorder) {
+                recorder->close();
+                std::cout << "Recorded " << recorder->getWrittenCount() << " frames to " << recordPath << ", dropped " << recorder->getDroppedCount() << std::endl;
+            }
             return 0;
         default:
             continue;
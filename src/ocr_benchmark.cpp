@@ -0,0 +1,178 @@
+/**
+ * @file ocr_benchmark.cpp
+ * @brief Compares tesseract models on labelled tile images.
+ *
+ * For each model this program measures how long the recognizer takes to
+ * initialize, how long each tile takes to recognize and how many tiles are
+ * recognized correctly. The tile images are named after their letter, e.g.
+ * A_0001.png, as for the tile_model target. Benchmark a trained model on images
+ * it was not trained on: either a directory of other images, or the list.eval
+ * file of images the tile_model target held out.
+ *
+ * Usage: my-project_ocr_benchmark <tile image directory | list.eval> [model ...]
+ *
+ * @author Aled Vaghela
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <filesystem>
+#include <opencv2/opencv.hpp>
+#include <opencv2/core/utils/logger.hpp>
+#include "text_recognizer.h"
+#include "tile_pitch_estimator.h"
+
+/**
+ * @struct LabelledTile
+ * @brief A tile image and the letter on it.
+ */
+struct LabelledTile {
+    cv::Mat image;
+    char letter;
+};
+
+/**
+ * @brief Checks if a tile image is named after its letter.
+ */
+bool isLabelled(const std::filesystem::path& path) {
+    const std::string name{ path.stem().string() };
+    return std::size(name) > 1 && name[0] >= 'A' && name[0] <= 'Z' && name[1] == '_';
+}
+
+/**
+ * @brief Loads the tile images whose names start with their letter.
+ *
+ * @param source Directory of tile images, or a list of files one per line such as the list.eval
+ *               written by the tile_model target, whose training files are read as the images beside them.
+ * @return The labelled tiles, in name order.
+ * @throw std::runtime_error If the directory or list does not exist.
+ */
+std::vector<LabelledTile> loadTiles(const std::filesystem::path& source) {
+    std::vector<std::filesystem::path> paths{};
+    if (std::filesystem::is_directory(source)) {
+        for (const auto& entry : std::filesystem::directory_iterator(source)) {
+            if (entry.is_regular_file() && isLabelled(entry.path())) paths.push_back(entry.path());
+        }
+    }
+    else {
+        std::ifstream list(source);
+        if (!list) { throw std::runtime_error("Cannot open tile image directory or list " + source.string() + "."); }
+        std::string line;
+        while (std::getline(list, line)) {
+            std::filesystem::path path{ line };
+            path.replace_extension(".png"); // tesseract's .lstmf training data is written next to the image
+            if (!line.empty() && isLabelled(path)) paths.push_back(path);
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<LabelledTile> tiles{};
+    for (const std::filesystem::path& path : paths) {
+        cv::Mat image{ cv::imread(path.string(), cv::IMREAD_COLOR) };
+        if (!image.empty()) tiles.push_back(LabelledTile{ image, path.stem().string()[0] });
+    }
+    return tiles;
+}
+
+/**
+ * @brief Milliseconds elapsed since a time point.
+ */
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Recognizes every tile with one model and prints the measurements.
+ *
+ * Each tile is recognized as an isolated tile in a frame of its own, so all
+ * orientations are tried, as for a tile in the pool.
+ *
+ * @param model Name of the tesseract model in the tessdata directory.
+ * @param tiles The labelled tiles.
+ * @throw std::runtime_error If tesseract cannot be initialized with the model.
+ */
+void benchmarkModel(const std::string& model, const std::vector<LabelledTile>& tiles) {
+    TilePitchEstimator tilePitchEstimator{};
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<TextRecognizer> textRecognizer{ TextRecognizer::createInstance(tilePitchEstimator, model) };
+    const double initMilliseconds{ millisecondsSince(start) };
+
+    std::vector<double> latencies{};
+    std::size_t correct{ 0 };
+    std::size_t unrecognized{ 0 };
+    for (const LabelledTile& tile : tiles) {
+        const cv::RotatedRect rect(cv::Point2f(tile.image.cols / 2.0f, tile.image.rows / 2.0f), cv::Size2f(tile.image.cols, tile.image.rows), 0.0f);
+        start = std::chrono::steady_clock::now();
+        std::vector<LetterNode> letterNodes{ textRecognizer->recognizeLetterNodes(tile.image, { rect }, false) };
+        latencies.push_back(millisecondsSince(start));
+        if (letterNodes.empty()) ++unrecognized;
+        else if (letterNodes.front().letter == tile.letter) ++correct;
+    }
+
+    // The first call includes tesseract's lazy initialization, so it is reported separately
+    const double firstCallMilliseconds{ latencies.front() };
+    std::vector<double> sorted(latencies.begin() + 1, latencies.end());
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) { return sorted.empty() ? 0.0 : sorted[static_cast<std::size_t>(p * (std::size(sorted) - 1))]; };
+    const double meanMilliseconds{ sorted.empty() ? 0.0 : std::accumulate(sorted.begin(), sorted.end(), 0.0) / std::size(sorted) };
+
+    std::cout << std::fixed << std::setprecision(2)
+        << std::left << std::setw(12) << model << std::right
+        << std::setw(10) << initMilliseconds
+        << std::setw(12) << firstCallMilliseconds
+        << std::setw(10) << meanMilliseconds
+        << std::setw(10) << percentile(0.5)
+        << std::setw(10) << percentile(0.95)
+        << std::setw(10) << 100.0 * correct / std::size(tiles)
+        << std::setw(8) << unrecognized << std::endl;
+}
+
+/**
+ * @brief Compares the models given on the command line, by default the stock and tile models.
+ *
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int main(int argc, char* argv[]) {
+    cv::utils::logging::setLogLevel(cv::utils::logging::LOG_LEVEL_WARNING); // reduce OpenCV log level
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <tile image directory | list.eval> [model ...]" << std::endl;
+        return -1;
+    }
+    std::vector<std::string> models(argv + 2, argv + argc);
+    if (models.empty()) models = { "eng", "tiles" };
+
+    std::vector<LabelledTile> tiles{};
+    try {
+        tiles = loadTiles(argv[1]);
+    }
+    catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+    if (tiles.empty()) {
+        std::cerr << "No tile images named <LETTER>_<anything> in " << argv[1] << std::endl;
+        return -1;
+    }
+
+    std::cout << tiles.size() << " tiles, times in ms\n"
+        << std::left << std::setw(12) << "model" << std::right
+        << std::setw(10) << "init" << std::setw(12) << "first call" << std::setw(10) << "mean"
+        << std::setw(10) << "median" << std::setw(10) << "p95" << std::setw(10) << "accuracy" << std::setw(8) << "missed" << std::endl;
+    for (const std::string& model : models) {
+        try {
+            benchmarkModel(model, tiles);
+        }
+        catch (const std::runtime_error& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,240 @@
+/**
+ * @file python_module.cpp
+ * @brief Python bindings for the detector, recognizer, letter graph and solver.
+ *
+ * This module lets a game be analysed from Python without running the
+ * executable. Frames are NumPy uint8 arrays which are wrapped by a cv::Mat
+ * without being copied, the GIL is released while a frame is processed, and
+ * tiles and letters are returned as NumPy structured arrays.
+ *
+ * @author Aled Vaghela
+ */
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include <opencv2/opencv.hpp>
+#include "text_detector.h"
+#include "text_recognizer.h"
+#include "letter_node_utils.h"
+#include "tile_pitch_estimator.h"
+#include "snatchable_word_generator.h"
+
+namespace py = pybind11;
+
+/**
+ * @struct TileRecord
+ * @brief Element of the structured arrays of tile locations.
+ */
+struct TileRecord {
+    float cx;
+    float cy;
+    float width;
+    float height;
+    float angle;
+};
+
+/**
+ * @struct LetterRecord
+ * @brief Element of the structured arrays of recognized letters.
+ */
+struct LetterRecord {
+    char letter[1];
+    float cx;
+    float cy;
+    float width;
+    float height;
+    float angle;
+};
+
+/**
+ * @brief Wraps a frame in a cv::Mat without copying it.
+ *
+ * The array must stay alive and unchanged while the cv::Mat is used.
+ *
+ * @param frame BGR frame of shape (height, width, 3) or grayscale frame of shape (height, width), of dtype uint8.
+ *              Rows may be strided, e.g. a crop of a larger frame, but the pixels of a row must be contiguous.
+ * @return A cv::Mat sharing the array's memory.
+ * @throw std::invalid_argument If the array is not a frame of that layout; raised as ValueError.
+ */
+static cv::Mat toMat(const py::array& frame) {
+    if (!py::isinstance<py::array_t<std::uint8_t>>(frame)) {
+        throw std::invalid_argument("Frame must have dtype uint8.");
+    }
+    const int channels{ frame.ndim() == 3 ? static_cast<int>(frame.shape(2)) : 1 };
+    if ((frame.ndim() != 2 && frame.ndim() != 3) || (channels != 1 && channels != 3)) {
+        throw std::invalid_argument("Frame must have shape (height, width) or (height, width, 3).");
+    }
+    if (frame.strides(1) != channels || (frame.ndim() == 3 && frame.strides(2) != 1) || frame.strides(0) < frame.shape(1) * channels) {
+        throw std::invalid_argument("Frame rows must be contiguous; pass numpy.ascontiguousarray(frame).");
+    }
+    return cv::Mat(static_cast<int>(frame.shape(0)), static_cast<int>(frame.shape(1)), CV_8UC(channels),
+        const_cast<void*>(frame.data()), static_cast<std::size_t>(frame.strides(0)));
+}
+
+static std::vector<cv::RotatedRect> toRotatedRects(const py::array_t<TileRecord, py::array::c_style | py::array::forcecast>& tiles) {
+    std::vector<cv::RotatedRect> rotatedRectangles{};
+    rotatedRectangles.reserve(tiles.size());
+    for (const TileRecord& tile : std::span<const TileRecord>(tiles.data(), tiles.size())) {
+        rotatedRectangles.emplace_back(cv::Point2f(tile.cx, tile.cy), cv::Size2f(tile.width, tile.height), tile.angle);
+    }
+    return rotatedRectangles;
+}
+
+static py::array_t<TileRecord> toTileArray(const std::vector<cv::RotatedRect>& rotatedRectangles) {
+    py::array_t<TileRecord> tiles(static_cast<py::ssize_t>(std::size(rotatedRectangles)));
+    TileRecord* records{ tiles.mutable_data() };
+    for (const cv::RotatedRect& rect : rotatedRectangles) {
+        *records++ = TileRecord{ rect.center.x, rect.center.y, rect.size.width, rect.size.height, rect.angle };
+    }
+    return tiles;
+}
+
+static std::vector<LetterNode> toLetterNodes(const py::array_t<LetterRecord, py::array::c_style | py::array::forcecast>& letters) {
+    std::vector<LetterNode> letterNodes{};
+    letterNodes.reserve(letters.size());
+    for (const LetterRecord& letter : std::span<const LetterRecord>(letters.data(), letters.size())) {
+        letterNodes.emplace_back(letter.letter[0], cv::RotatedRect(cv::Point2f(letter.cx, letter.cy), cv::Size2f(letter.width, letter.height), letter.angle));
+    }
+    return letterNodes;
+}
+
+static py::array_t<LetterRecord> toLetterArray(const std::vector<LetterNode>& letterNodes) {
+    py::array_t<LetterRecord> letters(static_cast<py::ssize_t>(std::size(letterNodes)));
+    LetterRecord* records{ letters.mutable_data() };
+    for (const LetterNode& letterNode : letterNodes) {
+        const cv::RotatedRect& rect{ letterNode.rect };
+        *records++ = LetterRecord{ { letterNode.letter }, rect.center.x, rect.center.y, rect.size.width, rect.size.height, rect.angle };
+    }
+    return letters;
+}
+
+/**
+ * @struct PyDetector
+ * @brief A detector of its own with its own tile size estimate, which a recognizer may share.
+ *
+ * Calls on the same detector from several Python threads are serialised.
+ */
+struct PyDetector {
+    std::shared_ptr<TilePitchEstimator> tilePitchEstimator{ std::make_shared<TilePitchEstimator>() };
+    std::unique_ptr<TextDetector> textDetector{ TextDetector::createInstance(*tilePitchEstimator) };
+    std::mutex mutex;
+};
+
+/**
+ * @struct PyRecognizer
+ * @brief A recognizer with its own tesseract engine.
+ *
+ * Calls on the same recognizer from several Python threads are serialised, so
+ * use one recognizer per thread to recognize frames in parallel.
+ */
+struct PyRecognizer {
+    std::shared_ptr<TilePitchEstimator> tilePitchEstimator;
+    std::unique_ptr<TextRecognizer> textRecognizer;
+    std::mutex mutex;
+};
+
+PYBIND11_NUMPY_DTYPE(TileRecord, cx, cy, width, height, angle);
+PYBIND11_NUMPY_DTYPE(LetterRecord, letter, cx, cy, width, height, angle);
+
+PYBIND11_MODULE(snatchbot, m) {
+    m.doc() = "Letter tile detection, recognition and snatchable word search.";
+    m.attr("tile_dtype") = py::dtype::of<TileRecord>();
+    m.attr("letter_dtype") = py::dtype::of<LetterRecord>();
+    m.attr("LEXICON_POPULAR") = Lexicon::Popular;
+    m.attr("LEXICON_OSPD") = Lexicon::Ospd;
+    m.attr("LEXICON_COLLINS") = Lexicon::Collins;
+    m.attr("LEXICON_ALL") = Lexicon::All;
+
+    py::class_<PyDetector>(m, "Detector", "Finds the letter tiles in a frame.")
+        .def(py::init([](bool backgroundModel) {
+            auto detector = std::make_unique<PyDetector>();
+            if (backgroundModel) detector->textDetector->setDetectionMode(TextDetector::DetectionMode::BackgroundModel);
+            return detector;
+        }), py::arg("background_model") = false,
+            "Creates a detector; with background_model tiles are whatever differs from the empty table passed to update_background.")
+        .def("detect", [](PyDetector& self, const py::array& frame, double scale) {
+            cv::Mat mat{ toMat(frame) };
+            std::vector<cv::RotatedRect> rotatedRectangles{};
+            {
+                py::gil_scoped_release release;
+                std::lock_guard<std::mutex> lock(self.mutex);
+                rotatedRectangles = self.textDetector->getTileLocations(mat, scale, false);
+            }
+            return toTileArray(rotatedRectangles);
+        }, py::arg("frame"), py::arg("scale") = 1.0,
+            "Returns the tiles in a uint8 frame as an array of tile_dtype, scaled by scale to full resolution coordinates.")
+        .def("update_background", [](PyDetector& self, const py::array& frame) {
+            cv::Mat mat{ toMat(frame) };
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.mutex);
+            self.textDetector->updateBackground(mat);
+        }, py::arg("frame"), "Updates the model of the empty table.");
+
+    py::class_<PyRecognizer>(m, "Recognizer", "Reads the letters on detected tiles.")
+        .def(py::init([](PyDetector* detector, const std::string& model, bool wholeWord) {
+            auto recognizer = std::make_unique<PyRecognizer>();
+            // The recognizer crops tiles to the tile size estimated by the detector which found them
+            recognizer->tilePitchEstimator = detector ? detector->tilePitchEstimator : std::make_shared<TilePitchEstimator>();
+            {
+                py::gil_scoped_release release;
+                recognizer->textRecognizer = TextRecognizer::createInstance(*recognizer->tilePitchEstimator, model);
+            }
+            if (wholeWord) recognizer->textRecognizer->setRecognitionMode(TextRecognizer::RecognitionMode::WholeWord);
+            return recognizer;
+        }), py::arg("detector") = py::none(), py::arg("model") = "eng", py::arg("whole_word") = false,
+            "Loads a tesseract model from the tessdata directory; pass the detector whose tiles will be recognized.")
+        .def("warm_up", [](PyRecognizer& self) {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.mutex);
+            self.textRecognizer->warmUp();
+        }, "Recognizes a synthetic tile so the first frame is not slowed down by tesseract's lazy initialization.")
+        .def("recognize", [](PyRecognizer& self, const py::array& frame, const py::array_t<TileRecord, py::array::c_style | py::array::forcecast>& tiles) {
+            cv::Mat mat{ toMat(frame) };
+            std::vector<cv::RotatedRect> rotatedRectangles{ toRotatedRects(tiles) };
+            std::vector<LetterNode> letterNodes{};
+            {
+                py::gil_scoped_release release;
+                std::lock_guard<std::mutex> lock(self.mutex);
+                letterNodes = self.textRecognizer->recognizeLetterNodes(mat, rotatedRectangles, false);
+            }
+            return toLetterArray(letterNodes);
+        }, py::arg("frame"), py::arg("tiles"),
+            "Returns the letter on each tile whose letter could be recognized as an array of letter_dtype.")
+        .def("words", [](PyRecognizer& self, const py::array& frame, const py::array_t<TileRecord, py::array::c_style | py::array::forcecast>& tiles) {
+            cv::Mat mat{ toMat(frame) };
+            std::vector<cv::RotatedRect> rotatedRectangles{ toRotatedRects(tiles) };
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(self.mutex);
+            return self.textRecognizer->generateWords(mat, rotatedRectangles);
+        }, py::arg("frame"), py::arg("tiles"), "Returns the words formed by the tiles in a frame.");
+
+    m.def("connect_letters", [](const py::array_t<LetterRecord, py::array::c_style | py::array::forcecast>& letters) {
+        std::vector<LetterNode> letterNodes{ toLetterNodes(letters) };
+        py::gil_scoped_release release;
+        return TextRecognizer::connectLetterNodes(letterNodes);
+    }, py::arg("letters"), "Groups an array of letter_dtype into words by connecting adjacent tiles.");
+
+    m.def("snatchable_words", [](const std::vector<std::string>& words, std::size_t minLength, LexiconMask lexicons) {
+        SnatchQuery query{ words };
+        query.minResultLength = minLength;
+        query.lexicons = lexicons;
+        py::gil_scoped_release release;
+        return SnatchableWordGenerator::getInstance().generateSnatchableWords(query);
+    }, py::arg("words"), py::arg("min_length") = 3, py::arg("lexicons") = Lexicon::Popular,
+        "Returns the words which can be snatched from the words on the board, single letters being tiles in the pool, "
+        "ordered by size and then alphabetically. The word lists are loaded from the working directory on first use.");
+
+    m.def("formable_words", [](const std::string& letters, LexiconMask lexicons) {
+        py::gil_scoped_release release;
+        return SnatchableWordGenerator::getInstance().generateFormableWords(letters, lexicons);
+    }, py::arg("letters"), py::arg("lexicons") = Lexicon::Popular,
+        "Returns every word which can be formed from some of the letters, ordered by size and then alphabetically.");
+}
@@ -0,0 +1,62 @@
+"""Smoke test of the snatchbot Python module.
+
+Run from the directory containing the module, tessdata and the word lists,
+e.g. through ctest after building with -DBUILD_PYTHON_MODULE=ON.
+"""
+
+import unittest
+
+import cv2
+import numpy as np
+
+import snatchbot
+
+TILE_SIZE = 60
+
+
+def draw_board(word, origin=(100, 100)):
+    """Draws a word as white tiles with black letters on a black table."""
+    frame = np.zeros((360, 640, 3), dtype=np.uint8)
+    x, y = origin
+    for letter in word:
+        cv2.rectangle(frame, (x, y), (x + TILE_SIZE - 1, y + TILE_SIZE - 1), (255, 255, 255), cv2.FILLED)
+        (width, height), _ = cv2.getTextSize(letter, cv2.FONT_HERSHEY_SIMPLEX, 1.5, 4)
+        cv2.putText(frame, letter, (x + (TILE_SIZE - width) // 2, y + (TILE_SIZE + height) // 2),
+                    cv2.FONT_HERSHEY_SIMPLEX, 1.5, (0, 0, 0), 4, cv2.LINE_AA)
+        x += TILE_SIZE + 6
+    return frame
+
+
+class SnatchbotTest(unittest.TestCase):
+    def test_detect_and_recognize(self):
+        frame = draw_board("CAT")
+        detector = snatchbot.Detector()
+        tiles = detector.detect(frame)
+        self.assertEqual(tiles.dtype, snatchbot.tile_dtype)
+        self.assertEqual(len(tiles), 3)
+        np.testing.assert_allclose(np.sort(tiles["cx"]), [130, 196, 262], atol=2)
+        np.testing.assert_allclose(tiles["cy"], 130, atol=2)
+
+        recognizer = snatchbot.Recognizer(detector)
+        recognizer.warm_up()
+        letters = recognizer.recognize(frame, tiles)
+        self.assertEqual(letters.dtype, snatchbot.letter_dtype)
+        self.assertGreater(len(letters), 0)
+        self.assertTrue(set(letters["letter"].astype(str)) <= set("CAT"))
+
+        words = snatchbot.connect_letters(letters)
+        self.assertEqual(len(words), 1)
+
+    def test_rejects_frames_of_the_wrong_type(self):
+        detector = snatchbot.Detector()
+        with self.assertRaises(ValueError):
+            detector.detect(np.zeros((10, 10, 3), dtype=np.float32))
+        with self.assertRaises(ValueError):
+            detector.detect(np.zeros((10, 10, 4), dtype=np.uint8))
+
+    def test_snatchable_words(self):
+        self.assertIn("TAMPER", snatchbot.snatchable_words(["PET", "RAM"]))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "anagram_index.h"
+
+TEST(AnagramIndexTest, GroupsAnagrams) {
+    std::istringstream words{ "pit\ntip\nat\ntrip\n" };
+    AnagramIndex index{ words };
+    EXPECT_EQ(std::size(index.getClasses()), 2) << "AT is too short to be kept";
+    const AnagramClass* anagramClass = index.findClass("IPT");
+    ASSERT_NE(anagramClass, nullptr);
+    EXPECT_EQ(anagramClass->anagrams, (std::vector<std::string>{ "PIT", "TIP" }));
+    EXPECT_EQ(index.findClass("AT"), nullptr);
+}
+
+TEST(AnagramIndexTest, FitsWithin) {
+    LetterCounts trip{};
+    LetterCounts pit{};
+    ASSERT_TRUE(AnagramIndex::countLetters("TRIP", trip));
+    ASSERT_TRUE(AnagramIndex::countLetters("PIT", pit));
+    EXPECT_TRUE(AnagramIndex::fitsWithin(pit, trip));
+    EXPECT_FALSE(AnagramIndex::fitsWithin(trip, pit));
+    EXPECT_FALSE(AnagramIndex::countLetters("P1T", pit)) << "Only A-Z are letters";
+}
+
+TEST(AnagramIndexTest, FindFittingClasses) {
+    std::istringstream words{ "pit\ntip\ntrip\nstrip\npitted\nzip\n" };
+    AnagramIndex index{ words };
+    LetterCounts query{};
+    ASSERT_TRUE(AnagramIndex::countLetters("PIRTXXXXXXXXXXXXXXXXXXXX", query));
+    std::vector<std::string> fitting{};
+    for (std::size_t i : index.findFittingClasses(query)) {
+        fitting.push_back(index.getClasses()[i].sortedWord);
+    }
+    EXPECT_EQ(fitting, (std::vector<std::string>{ "IPT", "IPRT" })) << "Classes are returned shortest first";
+
+    std::vector<std::size_t> longOnly = index.findFittingClasses(query, 4);
+    ASSERT_EQ(std::size(longOnly), 1);
+    EXPECT_EQ(index.getClasses()[longOnly[0]].sortedWord, "IPRT");
+}
+
+TEST(AnagramIndexTest, MergedLexicons) {
+    std::istringstream casual{ "pit\ntrip\n" };
+    std::istringstream tournament{ "pit\ntip\nzit\n" };
+    AnagramIndex index{ std::vector<std::istream*>{ &casual, &tournament } };
+    const AnagramClass* anagramClass = index.findClass("IPT");
+    ASSERT_NE(anagramClass, nullptr);
+    EXPECT_EQ(anagramClass->anagrams, (std::vector<std::string>{ "PIT", "TIP" })) << "PIT is stored once";
+    EXPECT_EQ(anagramClass->lexicons, (std::vector<LexiconMask>{ 0b11, 0b10 }));
+    EXPECT_EQ(anagramClass->lexiconMask, 0b11);
+
+    LetterCounts query{};
+    ASSERT_TRUE(AnagramIndex::countLetters("PITRZ", query));
+    EXPECT_EQ(std::size(index.findFittingClasses(query)), 3);
+    std::vector<std::size_t> casualOnly = index.findFittingClasses(query, 0, 0b01);
+    ASSERT_EQ(std::size(casualOnly), 2) << "ZIT is not in the first word list";
+    EXPECT_EQ(index.getClasses()[casualOnly[0]].sortedWord, "IPT");
+    EXPECT_EQ(index.getClasses()[casualOnly[1]].sortedWord, "IPRT");
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "batch_files.h"
+
+namespace {
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path);
+        std::ostringstream os;
+        os << file.rdbuf();
+        return os.str();
+    }
+}
+
+TEST(BatchFilesTest, PlanChunks) {
+    std::vector<ChunkJob> chunks{ BatchFiles::planChunks("game.mp4", 250, 100) };
+    ASSERT_EQ(std::size(chunks), 3);
+    EXPECT_EQ(chunks[0].startFrame, 0);
+    EXPECT_EQ(chunks[0].endFrame, 100);
+    EXPECT_EQ(chunks[1].startFrame, 100);
+    EXPECT_EQ(chunks[1].endFrame, 200);
+    EXPECT_EQ(chunks[2].startFrame, 200);
+    EXPECT_EQ(chunks[2].endFrame, -1); // the last chunk reads to the end
+    for (std::size_t i = 0; i < std::size(chunks); ++i) {
+        EXPECT_EQ(chunks[i].chunk, i);
+        EXPECT_EQ(chunks[i].numChunks, 3);
+    }
+
+    std::vector<ChunkJob> unknownLength{ BatchFiles::planChunks("game.mp4", -1, 100) };
+    ASSERT_EQ(std::size(unknownLength), 1);
+    EXPECT_EQ(unknownLength[0].startFrame, 0);
+    EXPECT_EQ(unknownLength[0].endFrame, -1);
+}
+
+TEST(BatchFilesTest, ObservationsRoundTrip) {
+    std::vector<BoardObservation> observations{
+        { 0.0, {} },
+        { 0.033366700033366704, { "PET", "RAM" } },
+    };
+    std::istringstream is(BatchFiles::formatObservations(observations));
+    std::vector<BoardObservation> parsed{ BatchFiles::parseObservations(is) };
+    ASSERT_EQ(std::size(parsed), std::size(observations));
+    for (std::size_t i = 0; i < std::size(parsed); ++i) {
+        EXPECT_EQ(parsed[i].timestamp, observations[i].timestamp);
+        EXPECT_EQ(parsed[i].words, observations[i].words);
+    }
+}
+
+TEST(BatchFilesTest, LogWrittenOnceEveryChunkIsSaved) {
+    const std::filesystem::path directory{ std::filesystem::temp_directory_path() / "test_batch_files" };
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::vector<ChunkJob> chunks{ BatchFiles::planChunks("games/game.mp4", 6, 3) };
+    ASSERT_EQ(std::size(chunks), 2);
+
+    BatchFiles::writeChunk(directory, chunks[1], { { 3.0, { "TAMPER" } }, { 4.0, { "TAMPER", "P", "I", "T" } }, { 5.0, { "TAMPER", "P", "I", "T" } } });
+    EXPECT_TRUE(BatchFiles::isDone(directory, chunks[1]));
+    EXPECT_FALSE(BatchFiles::isDone(directory, chunks[0])); // resumed from here
+    EXPECT_FALSE(BatchFiles::writeLogIfComplete(directory, chunks[1]));
+    EXPECT_FALSE(std::filesystem::exists(BatchFiles::logPath(directory, "games/game.mp4")));
+
+    BatchFiles::writeChunk(directory, chunks[0], { { 0.0, { "PET" } }, { 1.0, { "PET", "RAM" } }, { 2.0, { "RAM", "PET" } } });
+    EXPECT_TRUE(BatchFiles::writeLogIfComplete(directory, chunks[0]));
+    const std::string log{ readFile(BatchFiles::logPath(directory, "games/game.mp4")) };
+    EXPECT_NE(log.find("# 6 frames\n"), std::string::npos);
+    EXPECT_NE(log.find("TAMPER\t1\t3\n"), std::string::npos);
+    EXPECT_NE(log.find("PRIMATE\t4\t5\n"), std::string::npos);
+    EXPECT_FALSE(std::filesystem::exists(BatchFiles::partPath(directory, chunks[0])));
+    EXPECT_FALSE(std::filesystem::exists(BatchFiles::partPath(directory, chunks[1])));
+    EXPECT_TRUE(BatchFiles::isDone(directory, chunks[0]));
+    std::filesystem::remove_all(directory);
+}
+
+TEST(BatchFilesTest, VideosWithTheSameStemAreKeptApart) {
+    const std::filesystem::path directory{ std::filesystem::temp_directory_path() / "test_batch_files_stem" };
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const ChunkJob mp4{ BatchFiles::planChunks("games/game.mp4", -1, 3)[0] };
+    const ChunkJob mkv{ BatchFiles::planChunks("games/game.mkv", -1, 3)[0] };
+    EXPECT_NE(BatchFiles::logPath(directory, mp4.video), BatchFiles::logPath(directory, mkv.video));
+    EXPECT_NE(BatchFiles::partPath(directory, mp4), BatchFiles::partPath(directory, mkv));
+
+    BatchFiles::writeChunk(directory, mp4, { { 0.0, { "PET", "RAM" } } });
+    EXPECT_TRUE(BatchFiles::isDone(directory, mp4));
+    EXPECT_FALSE(BatchFiles::isDone(directory, mkv)) << "The second game is not skipped as already done";
+    BatchFiles::writeChunk(directory, mkv, { { 0.0, { "CAT" } } });
+    EXPECT_TRUE(BatchFiles::writeLogIfComplete(directory, mp4));
+    EXPECT_TRUE(BatchFiles::writeLogIfComplete(directory, mkv));
+    EXPECT_NE(readFile(BatchFiles::logPath(directory, "games/game.mp4")).find("# games/game.mp4\n"), std::string::npos);
+    EXPECT_NE(readFile(BatchFiles::logPath(directory, "games/game.mkv")).find("# games/game.mkv\n"), std::string::npos);
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "dynamic_letter_graph.h"
+
+class DynamicLetterGraphTest : public ::testing::Test {
+protected:
+    // Tiles are adjacent if their centres are less than 12 apart
+    static bool isAdjacent(LetterNode u, LetterNode v) {
+        return cv::norm(u.rect.center - v.rect.center) < 12;
+    }
+
+    DynamicLetterGraph graph{ isAdjacent, 12.0f };
+    std::vector<ComponentEvent> events;
+
+    void SetUp() override {
+        graph.addListener([this](const ComponentEvent& event) { events.push_back(event); });
+    }
+
+    static LetterNode tile(char letter, float x, float y) {
+        return LetterNode(letter, cv::RotatedRect(cv::Point2f(x, y), cv::Size2f(10, 10), 0.0));
+    }
+
+    std::vector<std::string> sortedWords() const {
+        std::vector<std::string> words{ graph.getWords() };
+        std::sort(words.begin(), words.end());
+        return words;
+    }
+};
+
+TEST_F(DynamicLetterGraphTest, AddAndMerge) {
+    graph.addTile(0, tile('C', 0, 0));
+    graph.addTile(1, tile('T', 20, 0));
+    ASSERT_EQ(std::size(events), 2);
+    EXPECT_EQ(events[0].kind, ComponentEvent::Kind::Added);
+    EXPECT_EQ(events[1].kind, ComponentEvent::Kind::Added);
+    EXPECT_EQ(sortedWords(), (std::vector<std::string>{ "C", "T" }));
+
+    // A joins both tiles into one word
+    events.clear();
+    graph.addTile(2, tile('A', 10, 0));
+    EXPECT_EQ(sortedWords(), (std::vector<std::string>{ "CAT" }));
+    EXPECT_EQ(graph.getComponent(0), graph.getComponent(1));
+    EXPECT_EQ(graph.getComponent(0), graph.getComponent(2));
+    ASSERT_EQ(std::size(events), 2);
+    EXPECT_EQ(events[0].kind, ComponentEvent::Kind::Removed);
+    EXPECT_EQ(events[1].kind, ComponentEvent::Kind::Changed);
+    EXPECT_EQ(events[1].component, graph.getComponent(2));
+    EXPECT_EQ(events[1].word, "CAT");
+    EXPECT_NE(events[0].component, events[1].component);
+    EXPECT_THROW(graph.addTile(2, tile('X', 100, 100)), std::invalid_argument);
+}
+
+TEST_F(DynamicLetterGraphTest, RemoveAndSplit) {
+    const std::string letters{ "SPLIT" };
+    for (std::size_t i = 0; i < std::size(letters); ++i) {
+        graph.addTile(i, tile(letters[i], 10.0f * i, -5));
+    }
+    EXPECT_EQ(sortedWords(), (std::vector<std::string>{ "SPLIT" }));
+    const DynamicLetterGraph::ComponentId word{ graph.getComponent(0) };
+
+    // Removing the L leaves SP and IT
+    events.clear();
+    graph.removeTile(2);
+    EXPECT_EQ(sortedWords(), (std::vector<std::string>{ "IT", "SP" }));
+    EXPECT_NE(graph.getComponent(0), graph.getComponent(4));
+    ASSERT_EQ(std::size(events), 2);
+    EXPECT_EQ(events[0].kind, ComponentEvent::Kind::Changed);
+    EXPECT_EQ(events[0].component, word);
+    EXPECT_EQ(events[1].kind, ComponentEvent::Kind::Added);
+
+    // Removing an end tile changes the word without splitting it
+    events.clear();
+    graph.removeTile(4);
+    EXPECT_EQ(sortedWords(), (std::vector<std::string>{ "I", "SP" }));
+    ASSERT_EQ(std::size(events), 1);
+    EXPECT_EQ(events[0].kind, ComponentEvent::Kind::Changed);
+
+    events.clear();
+    graph.removeTile(3);
+    ASSERT_EQ(std::size(events), 1);
+    EXPECT_EQ(events[0].kind, ComponentEvent::Kind::Removed);
+    EXPECT_EQ(graph.size(), 2);
+    EXPECT_THROW(graph.removeTile(3), std::out_of_range);
+}
+
+TEST_F(DynamicLetterGraphTest, WordsReadAlongTheirAxis) {
+    // A vertical word whose centres wander across the column
+    graph.addTile(0, tile('R', 1.5f, 0));
+    graph.addTile(1, tile('A', -1.0f, 10));
+    graph.addTile(2, tile('M', 0.5f, 20));
+    EXPECT_EQ(graph.getWord(graph.getComponent(0)), "RAM") << "Top to bottom";
+
+    // A horizontal word whose centres wander across the row
+    graph.addTile(3, tile('P', 100, 1.0f));
+    graph.addTile(4, tile('E', 110, -1.5f));
+    graph.addTile(5, tile('T', 120, 0.5f));
+    EXPECT_EQ(graph.getWord(graph.getComponent(3)), "PET") << "Left to right";
+}
+
+TEST_F(DynamicLetterGraphTest, MoveTile) {
+    graph.addTile(0, tile('A', 0, 0));
+    graph.addTile(1, tile('T', 10, 0));
+    graph.addTile(2, tile('O', 100, 100));
+    graph.addTile(3, tile('N', 110, 100));
+    graph.moveTile(0, tile('A', 90, 100));
+    EXPECT_EQ(sortedWords(), (std::vector<std::string>{ "AON", "T" }));
+    graph.moveTile(1, tile('I', 120, 100));
+    EXPECT_EQ(sortedWords(), (std::vector<std::string>{ "AONI" }));
+}
+
+TEST_F(DynamicLetterGraphTest, MatchesStaticGraph) {
+    // Build a board tile by tile, removing some tiles on the way
+    std::vector<LetterNode> nodes{};
+    for (int i = 0; i < 40; ++i) {
+        nodes.push_back(tile(static_cast<char>('A' + i % 26), static_cast<float>((i * 37) % 90), static_cast<float>((i * 53) % 70)));
+    }
+    for (std::size_t i = 0; i < std::size(nodes); ++i) graph.addTile(i, nodes[i]);
+    std::vector<LetterNode> remaining{};
+    for (std::size_t i = 0; i < std::size(nodes); ++i) {
+        if (i % 3 == 0) graph.removeTile(i);
+        else remaining.push_back(nodes[i]);
+    }
+
+    std::vector<std::string> expected{ LetterNodeUtils::findConnectedComponents(LetterNodeUtils::createLetterNodeGraph(remaining, isAdjacent)) };
+    std::vector<std::string> actual{ graph.getWords() };
+    ASSERT_EQ(std::size(actual), std::size(expected));
+    for (std::string& word : expected) std::sort(word.begin(), word.end());
+    for (std::string& word : actual) std::sort(word.begin(), word.end());
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    EXPECT_EQ(actual, expected);
+}
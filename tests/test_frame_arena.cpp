@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "frame_arena.h"
+
+namespace {
+    // Allocates a frame's worth of containers from the arena
+    std::size_t buildFrame(std::pmr::memory_resource* resource, std::size_t n) {
+        std::pmr::vector<std::pmr::string> words{ resource };
+        for (std::size_t i = 0; i < n; ++i) {
+            words.emplace_back(std::string(32, static_cast<char>('A' + i % 26)));
+        }
+        return std::size(words);
+    }
+}
+
+TEST(FrameArenaTest, GrowsUntilAFrameFits) {
+    FrameArena frameArena{ 1024 };
+    EXPECT_EQ(frameArena.capacity(), 1024);
+
+    EXPECT_EQ(buildFrame(frameArena.resource(), 1000), 1000);
+    frameArena.reset();
+    EXPECT_EQ(frameArena.getGrowCount(), 1) << "The first frame did not fit";
+    EXPECT_GT(frameArena.capacity(), 1024);
+
+    for (int frame = 0; frame < 10; ++frame) {
+        EXPECT_EQ(buildFrame(frameArena.resource(), 1000), 1000);
+        frameArena.reset();
+    }
+    EXPECT_EQ(frameArena.getGrowCount(), 1) << "Frames of the same size fit in the grown buffer";
+}
+
+TEST(FrameArenaTest, SmallFramesDoNotGrow) {
+    FrameArena frameArena{};
+    const std::size_t capacity{ frameArena.capacity() };
+    for (int frame = 0; frame < 10; ++frame) {
+        buildFrame(frameArena.resource(), 10);
+        frameArena.reset();
+    }
+    EXPECT_EQ(frameArena.getGrowCount(), 0);
+    EXPECT_EQ(frameArena.capacity(), capacity);
+}
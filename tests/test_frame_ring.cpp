@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "frame_ring.h"
+
+class FrameRingTest : public ::testing::Test {
+protected:
+    cv::Mat sharp, blurred;
+
+    void SetUp() override {
+        sharp = cv::Mat(240, 320, CV_8UC3, cv::Scalar(0, 0, 0));
+        for (int y = 0; y < sharp.rows; y += 16) {
+            for (int x = (y / 16) % 2 * 16; x < sharp.cols; x += 32) {
+                cv::rectangle(sharp, cv::Rect(x, y, 16, 16), cv::Scalar(255, 255, 255), cv::FILLED);
+            }
+        }
+        cv::GaussianBlur(sharp, blurred, cv::Size(15, 15), 5);
+    }
+
+    static bool same(const cv::Mat& a, const cv::Mat& b) {
+        return a.size() == b.size() && cv::norm(a, b, cv::NORM_INF) == 0;
+    }
+};
+
+TEST_F(FrameRingTest, Sharpness) {
+    EXPECT_GT(FrameRing::sharpness(sharp), FrameRing::sharpness(blurred));
+    EXPECT_EQ(FrameRing::sharpness(cv::Mat{}), 0);
+}
+
+TEST_F(FrameRingTest, SharpestRecentFrame) {
+    FrameRing ring{ 3 };
+    EXPECT_TRUE(ring.empty());
+    EXPECT_THROW(ring.getSharpest(), std::runtime_error);
+
+    ring.push(blurred);
+    ring.push(sharp);
+    ring.push(blurred);
+    EXPECT_EQ(ring.size(), 3);
+    EXPECT_TRUE(same(ring.getSharpest(), sharp));
+
+    ring.push(blurred);
+    ring.push(blurred);
+    EXPECT_EQ(ring.size(), 3);
+    EXPECT_TRUE(same(ring.getSharpest(), blurred)) << "The sharp frame is no longer recent";
+}
+
+TEST_F(FrameRingTest, FramesOldestFirst) {
+    FrameRing ring{ 2 };
+    ring.push(sharp);
+    ring.push(blurred);
+    ring.push(sharp);
+    std::vector<cv::Mat> frames{ ring.getFrames() };
+    ASSERT_EQ(std::size(frames), 2);
+    EXPECT_TRUE(same(frames[0], blurred));
+    EXPECT_TRUE(same(frames[1], sharp));
+    EXPECT_THROW(FrameRing{ 0 }, std::invalid_argument);
+}
+
+TEST_F(FrameRingTest, FramesExceptSharpest) {
+    FrameRing ring{ 3 };
+    EXPECT_TRUE(ring.getFramesExceptSharpest().empty());
+    ring.push(blurred);
+    ring.push(sharp);
+    ring.push(blurred.clone());
+    std::vector<cv::Mat> frames{ ring.getFramesExceptSharpest() };
+    ASSERT_EQ(std::size(frames), 2) << "The sharpest frame is processed, so it is not fused with itself";
+    EXPECT_TRUE(same(frames[0], blurred));
+    EXPECT_TRUE(same(frames[1], blurred));
+}
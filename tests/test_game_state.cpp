@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "game_state.h"
+
+TEST(GameStateTest, Updates) {
+    GameState empty;
+    GameState one = empty.withWordAdded("PET");
+    GameState two = one.withWordAdded("RAM");
+    GameState snatched = two.withWordRemoved(1).withWordReplaced(0, "TAMPER");
+
+    EXPECT_TRUE(empty.getWords().empty()) << "Snapshots are never modified";
+    EXPECT_EQ(two.getWordList(), (std::vector<std::string>{ "PET", "RAM" }));
+    EXPECT_EQ(snatched.getWordList(), (std::vector<std::string>{ "TAMPER" }));
+    EXPECT_EQ(snatched.getVersion(), 4);
+    EXPECT_THROW(snatched.withWordRemoved(1), std::out_of_range);
+}
+
+TEST(GameStateTest, StructuralSharing) {
+    GameState state;
+    const std::size_t numWords{ 3 * PersistentVector<std::string>::chunkSize };
+    for (std::size_t i = 0; i < numWords; ++i) { state = state.withWordAdded(std::to_string(i)); }
+    GameState next = state.withWordReplaced(0, "TAMPER");
+
+    EXPECT_NE(next.getWords().getChunk(0), state.getWords().getChunk(0)) << "The modified chunk is copied";
+    EXPECT_EQ(next.getWords().getChunk(1), state.getWords().getChunk(1)) << "Other chunks are shared";
+    EXPECT_EQ(next.getWords().getChunk(2), state.getWords().getChunk(2)) << "Other chunks are shared";
+    EXPECT_EQ(state.getWords().at(0), "0");
+    EXPECT_EQ(next.getWords().at(0), "TAMPER");
+
+    GameState shorter = next.withWordRemoved(numWords - 1);
+    EXPECT_EQ(shorter.getWords().size(), numWords - 1);
+    EXPECT_EQ(shorter.getWords().getChunk(1), state.getWords().getChunk(1));
+}
+
+TEST(GameStateTest, ConcurrentReaders) {
+    GameStateStore store;
+    std::atomic<bool> done{ false };
+    std::atomic<bool> consistent{ true };
+    std::thread reader([&]() {
+        while (!done) {
+            std::shared_ptr<const GameState> snapshot = store.load();
+            // Every published snapshot holds one word per version
+            if (snapshot->getWords().size() != snapshot->getVersion()) { consistent = false; }
+        }
+    });
+    for (int i = 0; i < 1000; ++i) {
+        store.update([i](const GameState& state) { return state.withWordAdded(std::to_string(i)); });
+    }
+    done = true;
+    reader.join();
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(store.load()->getVersion(), 1000);
+}
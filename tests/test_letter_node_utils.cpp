@@ -122,3 +122,94 @@ TEST_F(LetterNodeUtilsFindConnectedComponentsTest, Complex) {
     EXPECT_TRUE(std::find(words.begin(), words.end(), "D") != words.end()) << "'D' is missing";
     EXPECT_TRUE(std::find(words.begin(), words.end(), "EF") != words.end()) << "'EF' is missing";
 }
+
+TEST(LetterNodeUtilsTest, CreateGraphGridMatchesAllPairs) {
+    // Define a relation u ~ v iff their centres are less than 12 apart
+    auto isAdjacentFunction = [](LetterNode u, LetterNode v) { return cv::norm(u.rect.center - v.rect.center) < 12; };
+
+    std::vector<LetterNode> letterNodes;
+    const cv::Point2f centers[] = { {5, 5}, {15, 5}, {25, 5}, {5, 15}, {-6, 5}, {40, 40}, {51, 40}, {100, -3} };
+    char letter = 'A';
+    for (const cv::Point2f& center : centers) {
+        letterNodes.push_back(LetterNode(letter++, cv::RotatedRect(center, cv::Size2f(10, 10), 0.0)));
+    }
+    std::unordered_map<LetterNode, std::unordered_set<LetterNode>> graph{ LetterNodeUtils::createLetterNodeGraph(letterNodes, isAdjacentFunction) };
+    std::unordered_map<LetterNode, std::unordered_set<LetterNode>> gridGraph{ LetterNodeUtils::createLetterNodeGraph(letterNodes, isAdjacentFunction, 12.0f) };
+    EXPECT_EQ(gridGraph, graph) << "Only nodes in neighbouring cells can be adjacent";
+}
+
+TEST(LetterNodeUtilsTest, PitchAdjacencyStrategy) {
+    cv::Size2f size(10, 10);
+    LetterNode A('A', cv::RotatedRect(cv::Point2f(5, 5), size, 0.0));
+    LetterNode B('B', cv::RotatedRect(cv::Point2f(17, 5), size, 0.0));
+    LetterNode C('C', cv::RotatedRect(cv::Point2f(5, 15), size, 0.0));
+    EXPECT_TRUE(LetterNodeUtils::pitchAdjacencyStrategy(A, B)) << "Tiles are one side and a gap apart";
+    EXPECT_TRUE(LetterNodeUtils::pitchAdjacencyStrategy(A, C)) << "Tiles are vertically right next to each other";
+    EXPECT_FALSE(LetterNodeUtils::pitchAdjacencyStrategy(C, B)) << "Tiles are diagonal from each other";
+
+    // The same word twice as far from a tilted camera
+    LetterNode farA('A', cv::RotatedRect(cv::Point2f(5, 5), cv::Size2f(5, 5), 0.0));
+    LetterNode farB('B', cv::RotatedRect(cv::Point2f(11, 5), cv::Size2f(5, 5), 0.0));
+    LetterNode farC('C', cv::RotatedRect(cv::Point2f(5, 10), cv::Size2f(5, 5), 0.0));
+    EXPECT_TRUE(LetterNodeUtils::pitchAdjacencyStrategy(farA, farB)) << "Adjacency does not depend on the scale";
+    EXPECT_FALSE(LetterNodeUtils::pitchAdjacencyStrategy(farC, farB)) << "Adjacency does not depend on the scale";
+    EXPECT_FALSE(LetterNodeUtils::pitchAdjacencyStrategy(farA, C)) << "Small tiles are not adjacent to a large tile one small pitch away";
+
+    // Only nodes in neighbouring cells can be adjacent
+    std::vector<LetterNode> letterNodes{ A, B, C, farA, farB, farC };
+    letterNodes.push_back(LetterNode('D', cv::RotatedRect(cv::Point2f(30, 5), cv::Size2f(16, 16), 0.0)));
+    const float cellSize{ LetterNodeUtils::pitchAdjacencyCellSize(letterNodes) };
+    EXPECT_FLOAT_EQ(cellSize, 16 * LetterNodeUtils::adjacencyInTileSizes);
+    EXPECT_EQ(LetterNodeUtils::createLetterNodeGraph(letterNodes, LetterNodeUtils::pitchAdjacencyStrategy, cellSize),
+        LetterNodeUtils::createLetterNodeGraph(letterNodes, LetterNodeUtils::pitchAdjacencyStrategy));
+}
+
+TEST(LetterNodeUtilsTest, PmrGraphMatchesGraph) {
+    // Define a relation u ~ v iff their centres are less than 12 apart
+    auto isAdjacentFunction = [](LetterNode u, LetterNode v) { return cv::norm(u.rect.center - v.rect.center) < 12; };
+
+    std::vector<LetterNode> letterNodes;
+    const cv::Point2f centers[] = { {5, 5}, {15, 5}, {25, 5}, {5, 15}, {-6, 5}, {40, 40}, {51, 40}, {100, -3} };
+    char letter = 'A';
+    for (const cv::Point2f& center : centers) {
+        letterNodes.push_back(LetterNode(letter++, cv::RotatedRect(center, cv::Size2f(10, 10), 0.0)));
+    }
+    std::unordered_map<LetterNode, std::unordered_set<LetterNode>> graph{ LetterNodeUtils::createLetterNodeGraph(letterNodes, isAdjacentFunction) };
+
+    // Everything must come from the arena
+    std::byte buffer[64 * 1024];
+    std::pmr::monotonic_buffer_resource arena{ buffer, sizeof(buffer), std::pmr::null_memory_resource() };
+    for (float cellSize : { 0.0f, 12.0f }) {
+        LetterNodeUtils::PmrLetterNodeGraph pmrGraph{ cellSize > 0
+            ? LetterNodeUtils::createLetterNodeGraph(letterNodes, isAdjacentFunction, cellSize, &arena)
+            : LetterNodeUtils::createLetterNodeGraph(letterNodes, isAdjacentFunction, &arena) };
+        ASSERT_EQ(std::size(pmrGraph), std::size(graph));
+        for (const auto& [u, neighbours] : graph) {
+            ASSERT_TRUE(pmrGraph.contains(u));
+            EXPECT_EQ(std::unordered_set<LetterNode>(pmrGraph.at(u).begin(), pmrGraph.at(u).end()), neighbours);
+        }
+
+        std::vector<std::string> words{ LetterNodeUtils::findConnectedComponents(graph) };
+        std::pmr::vector<std::pmr::string> pmrWords{ LetterNodeUtils::findConnectedComponents(pmrGraph, &arena) };
+        std::vector<std::string> sortedWords{}, sortedPmrWords{};
+        for (std::string word : words) { std::sort(word.begin(), word.end()); sortedWords.push_back(word); }
+        for (const std::pmr::string& pmrWord : pmrWords) { std::string word(pmrWord); std::sort(word.begin(), word.end()); sortedPmrWords.push_back(word); }
+        std::sort(sortedWords.begin(), sortedWords.end());
+        std::sort(sortedPmrWords.begin(), sortedPmrWords.end());
+        EXPECT_EQ(sortedPmrWords, sortedWords);
+    }
+}
+
+TEST(LetterNodeUtilsTest, GroupConnectedNodes) {
+    // Two words, one of them with two identical tiles stacked, and a lone tile
+    std::vector<LetterNode> letterNodes;
+    const cv::Point2f centers[] = { {5, 5}, {100, 100}, {17, 5}, {112, 100}, {29, 5}, {112, 100}, {50, 60} };
+    for (const cv::Point2f& center : centers) {
+        letterNodes.push_back(LetterNode('\0', cv::RotatedRect(center, cv::Size2f(10, 10), 0.0)));
+    }
+    const std::vector<std::vector<std::size_t>> expected{ { 0, 2, 4 }, { 1, 3, 5 }, { 6 } };
+    EXPECT_EQ(LetterNodeUtils::groupConnectedNodes(letterNodes, LetterNodeUtils::pitchAdjacencyStrategy, 0.0f), expected);
+    EXPECT_EQ(LetterNodeUtils::groupConnectedNodes(letterNodes, LetterNodeUtils::pitchAdjacencyStrategy,
+        LetterNodeUtils::pitchAdjacencyCellSize(letterNodes)), expected) << "Only nodes in neighbouring cells can be adjacent";
+    EXPECT_TRUE(LetterNodeUtils::groupConnectedNodes({}, LetterNodeUtils::pitchAdjacencyStrategy, 0.0f).empty());
+}
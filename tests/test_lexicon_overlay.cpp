@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+#include "lexicon_overlay.h"
+
+TEST(LexiconOverlayTest, Empty) {
+    LexiconOverlay overlay;
+    EXPECT_TRUE(overlay.empty());
+    EXPECT_FALSE(overlay.mayAffect("IPT")) << "Nothing is affected by an empty overlay";
+    EXPECT_FALSE(overlay.allowWord("at", 1)) << "Two letter words can never be snatched";
+    EXPECT_TRUE(overlay.empty());
+}
+
+TEST(LexiconOverlayTest, AllowAndBan) {
+    LexiconOverlay overlay;
+    ASSERT_TRUE(overlay.allowWord("zorp", 0b01));
+    ASSERT_TRUE(overlay.banWord("tip"));
+    EXPECT_FALSE(overlay.empty());
+    EXPECT_TRUE(overlay.mayAffect("OPRZ"));
+    EXPECT_TRUE(overlay.mayAffect("IPT"));
+    EXPECT_TRUE(overlay.isBanned("TIP"));
+
+    const AnagramClass* added = overlay.findAddedClass("OPRZ");
+    ASSERT_NE(added, nullptr);
+    EXPECT_EQ(added->anagrams, (std::vector<std::string>{ "ZORP" }));
+    EXPECT_EQ(added->lexiconMask, 0b01);
+
+    ASSERT_TRUE(overlay.banWord("ZORP"));
+    EXPECT_TRUE(overlay.findAddedClass("OPRZ")->anagrams.empty()) << "Banning removes an added word";
+    ASSERT_TRUE(overlay.allowWord("tip", 0b01));
+    EXPECT_FALSE(overlay.isBanned("TIP")) << "Allowing lifts a ban";
+}
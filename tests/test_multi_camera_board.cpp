@@ -0,0 +1,38 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "multi_camera_board.h"
+
+namespace {
+    MultiCameraBoard::TableTile tableTile(char letter, cv::Point2f center, float cameraArea) {
+        return MultiCameraBoard::TableTile{ LetterNode(letter, cv::RotatedRect(center, cv::Size2f(10, 10), 0.0f)), cameraArea, 0 };
+    }
+}
+
+TEST(MultiCameraBoardTest, ToTable) {
+    // Halves camera pixels and shifts them by (10, 20)
+    cv::Mat homography = (cv::Mat_<double>(3, 3) << 0.5, 0, 10, 0, 0.5, 20, 0, 0, 1);
+    LetterNode letterNode('Q', cv::RotatedRect(cv::Point2f(100, 50), cv::Size2f(20, 20), 30.0f));
+    LetterNode tableNode{ MultiCameraBoard::toTable(letterNode, homography) };
+    EXPECT_EQ(tableNode.letter, 'Q');
+    EXPECT_NEAR(tableNode.rect.center.x, 60.0f, 1e-3);
+    EXPECT_NEAR(tableNode.rect.center.y, 45.0f, 1e-3);
+    EXPECT_NEAR(tableNode.rect.size.area(), 100.0f, 1e-2);
+}
+
+TEST(MultiCameraBoardTest, DeduplicateKeepsLargestView) {
+    std::vector<std::vector<MultiCameraBoard::TableTile>> cameraTiles{
+        { tableTile('A', { 0, 0 }, 400), tableTile('B', { 12, 0 }, 400) },
+        { tableTile('A', { 2, 1 }, 900), tableTile('C', { 40, 0 }, 900), tableTile('D', { 43, 0 }, 900) },
+    };
+    std::vector<LetterNode> letterNodes{ MultiCameraBoard::deduplicate(cameraTiles) };
+    ASSERT_EQ(std::size(letterNodes), 4) << "The A seen by both cameras is kept once";
+
+    auto a = std::find_if(letterNodes.begin(), letterNodes.end(), [](const LetterNode& letterNode) { return letterNode.letter == 'A'; });
+    ASSERT_NE(a, letterNodes.end());
+    EXPECT_EQ(a->rect.center, cv::Point2f(2, 1)) << "From the camera which sees it largest";
+    EXPECT_EQ(std::count_if(letterNodes.begin(), letterNodes.end(), [](const LetterNode& letterNode) { return letterNode.letter == 'D'; }), 1)
+        << "Close tiles from the same camera are different tiles";
+
+    EXPECT_TRUE(MultiCameraBoard::deduplicate({}).empty());
+    EXPECT_TRUE(MultiCameraBoard::deduplicate({ {}, {} }).empty());
+}
@@ -0,0 +1,41 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "pool_tracker.h"
+
+class PoolTrackerTest : public ::testing::Test {
+protected:
+    std::istringstream words{ "pit\ntip\ntrip\ntipi\nzit\n" };
+    AnagramIndex index{ words };
+
+    std::vector<std::string> sortedWords(const std::vector<std::size_t>& classIndices) {
+        std::vector<std::string> result{};
+        for (std::size_t i : classIndices) { result.push_back(index.getClasses()[i].sortedWord); }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+};
+
+TEST_F(PoolTrackerTest, FlipTiles) {
+    PoolTracker tracker{ index };
+    EXPECT_TRUE(tracker.flipTile('P').empty());
+    EXPECT_TRUE(tracker.flipTile('I').empty());
+    EXPECT_EQ(sortedWords(tracker.flipTile('T')), (std::vector<std::string>{ "IPT" }));
+    EXPECT_EQ(sortedWords(tracker.flipTile('R')), (std::vector<std::string>{ "IPRT" }));
+    EXPECT_EQ(sortedWords(tracker.flipTile('I')), (std::vector<std::string>{ "IIPT" })) << "TIPI needs the second I";
+    EXPECT_TRUE(tracker.flipTile('I').empty()) << "No word needs a third I";
+    EXPECT_EQ(tracker.getPool()['I' - 'A'], 3);
+}
+
+TEST_F(PoolTrackerTest, RemoveTiles) {
+    PoolTracker tracker{ index };
+    for (char letter : std::string("PITIZ")) { tracker.flipTile(letter); }
+    EXPECT_EQ(sortedWords(tracker.removeTile('I')), (std::vector<std::string>{ "IIPT" })) << "One I is still enough for PIT and ZIT";
+    EXPECT_EQ(sortedWords(tracker.removeTile('T')), (std::vector<std::string>{ "IPT", "ITZ" }));
+    EXPECT_THROW(tracker.removeTile('T'), std::invalid_argument);
+    EXPECT_EQ(sortedWords(tracker.flipTile('T')), (std::vector<std::string>{ "IPT", "ITZ" }));
+
+    const AnagramClass* pit = index.findClass("IPT");
+    ASSERT_NE(pit, nullptr);
+    EXPECT_EQ(tracker.getWords(pit - index.getClasses().data()), (std::vector<std::string>{ "PIT", "TIP" }));
+    EXPECT_EQ(tracker.getDeficit(index.findClass("IPRT") - index.getClasses().data()), 1);
+}
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+#include "session_analyzer.h"
+
+TEST(SessionAnalyzerTest, CanonicalBoardKey) {
+    EXPECT_EQ(SessionAnalyzer::canonicalBoardKey({ "RAM", "PET" }), SessionAnalyzer::canonicalBoardKey({ "PET", "RAM" }));
+    EXPECT_NE(SessionAnalyzer::canonicalBoardKey({ "PE", "TRAM" }), SessionAnalyzer::canonicalBoardKey({ "PET", "RAM" }));
+}
+
+TEST(SessionAnalyzerTest, NoObservations) {
+    EXPECT_TRUE(SessionAnalyzer::findAvailabilityWindows({}).empty());
+}
+
+TEST(SessionAnalyzerTest, AvailabilityWindows) {
+    std::vector<BoardObservation> observations{
+        { 0.0, { "PET" } },
+        { 1.0, { "PET", "RAM" } },
+        { 2.0, { "RAM", "PET" } },
+        { 3.0, { "TAMPER" } },
+        { 4.0, { "TAMPER", "P", "I", "T" } },
+        { 5.0, { "TAMPER", "P", "I", "T" } },
+    };
+    std::vector<AvailabilityWindow> windows = SessionAnalyzer::findAvailabilityWindows(observations, SnatchQuery{}, 2);
+    std::vector<AvailabilityWindow> expected{
+        { "TAMPER", 1.0, 3.0 },
+        { "PIT", 4.0, 5.0 },
+        { "PRIMATE", 4.0, 5.0 },
+        { "TIP", 4.0, 5.0 },
+    };
+    EXPECT_EQ(windows, expected);
+}
@@ -1,9 +1,16 @@
 #include <gtest/gtest.h>
 #include "snatchable_word_generator.h"
+#include "letter_node_utils.h"
+#include "frame_arena.h"
 
 class TestSnatchableWordGenerator : public ::testing::Test {
 protected:
 	SnatchableWordGenerator& swg{ SnatchableWordGenerator::getInstance() };
+
+	void TearDown() override {
+		// The generator is shared by every test, so house rules must not outlive a failed one
+		swg.clearHouseRules();
+	}
 };
 
 TEST_F(TestSnatchableWordGenerator, NoWords) {
@@ -43,3 +50,162 @@ TEST_F(TestSnatchableWordGenerator, ComplexExample) {
 	EXPECT_NE(std::find(snatchable.begin(), snatchable.end(), "MARE"), snatchable.end()) << "MARE expected to be snatchable";
 	EXPECT_NE(std::find(snatchable.begin(), snatchable.end(), "REAM"), snatchable.end()) << "REAM expected to be snatchable";
 }
+
+TEST_F(TestSnatchableWordGenerator, DictionaryDrivenMatchesSubsetDriven) {
+	using SolveMode = SnatchableWordGenerator::SolveMode;
+	std::vector<std::vector<std::string>> boards{ {}, { "O", "A", "N" }, { "P", "I", "T", "R" }, { "PET", "RAM" }, { "PET", "RAM", "E" }, { "CART", "K", "S", "E", "TRACK" } };
+	for (const std::vector<std::string>& words : boards) {
+		std::vector<std::string> subsetDriven = swg.generateSnatchableWords(words, SolveMode::SubsetDriven);
+		std::vector<std::string> dictionaryDriven = swg.generateSnatchableWords(words, SolveMode::DictionaryDriven);
+		EXPECT_EQ(subsetDriven, dictionaryDriven);
+	}
+}
+
+TEST_F(TestSnatchableWordGenerator, DictionaryDrivenNeedsTwoWords) {
+	std::vector<std::string> words{ "TRIP", "X" };
+	std::vector<std::string> snatchable = swg.generateSnatchableWords(words, SnatchableWordGenerator::SolveMode::DictionaryDriven);
+	EXPECT_EQ(std::find(snatchable.begin(), snatchable.end(), "TRIP"), snatchable.end()) << "TRIP is formed from a single word";
+}
+
+TEST_F(TestSnatchableWordGenerator, DictionaryDrivenLargeBoard) {
+	std::vector<std::string> words{ "PET", "RAM", "Q", "Z", "X", "J", "V", "K", "W", "Y", "F", "H", "B", "C", "G", "D", "U", "L", "Q", "Z", "X", "J" };
+	std::vector<std::string> snatchable = swg.generateSnatchableWords(words);
+	EXPECT_NE(std::find(snatchable.begin(), snatchable.end(), "TAMPER"), snatchable.end()) << "TAMPER expected to be snatchable";
+}
+
+TEST_F(TestSnatchableWordGenerator, FormableWords) {
+	std::vector<std::string> formable = swg.generateFormableWords("PITR");
+	EXPECT_EQ(formable, (std::vector<std::string>{ "TRIP", "PIT", "RIP", "TIP" }));
+}
+
+TEST_F(TestSnatchableWordGenerator, QueryRestrictions) {
+	using SolveMode = SnatchableWordGenerator::SolveMode;
+	SnatchQuery query{ { "PET", "RAM", "E" } };
+	query.minResultLength = 5;
+	for (SolveMode mode : { SolveMode::SubsetDriven, SolveMode::DictionaryDriven }) {
+		EXPECT_EQ(swg.generateSnatchableWords(query, mode), (std::vector<std::string>{ "TAMPER" })) << "MARE and REAM are too short";
+	}
+
+	query = SnatchQuery{ { "PET", "RAM", "E" } };
+	query.requirePoolTile = true;
+	for (SolveMode mode : { SolveMode::SubsetDriven, SolveMode::DictionaryDriven }) {
+		EXPECT_EQ(swg.generateSnatchableWords(query, mode), (std::vector<std::string>{ "MARE", "REAM" })) << "TAMPER does not use a pool tile";
+	}
+
+	query = SnatchQuery{ { "PET", "RAM", "E" } };
+	query.requiredWords = { 0 };
+	for (SolveMode mode : { SolveMode::SubsetDriven, SolveMode::DictionaryDriven }) {
+		EXPECT_EQ(swg.generateSnatchableWords(query, mode), (std::vector<std::string>{ "TAMPER" })) << "Only TAMPER uses PET";
+	}
+
+	query = SnatchQuery{ { "P", "I", "T", "R" } };
+	query.maxSourceWords = 3;
+	for (SolveMode mode : { SolveMode::SubsetDriven, SolveMode::DictionaryDriven }) {
+		EXPECT_EQ(swg.generateSnatchableWords(query, mode), (std::vector<std::string>{ "PIT", "RIP", "TIP" })) << "TRIP needs four words";
+	}
+}
+
+TEST_F(TestSnatchableWordGenerator, MergedLexicons) {
+	using SolveMode = SnatchableWordGenerator::SolveMode;
+	SnatchQuery query{ { "PET", "RAM" } };
+	query.lexicons = Lexicon::All;
+	for (SolveMode mode : { SolveMode::SubsetDriven, SolveMode::DictionaryDriven }) {
+		std::vector<SnatchablePlay> plays = swg.generateSnatchablePlays(query, mode);
+		auto tamper = std::find_if(plays.begin(), plays.end(), [](const SnatchablePlay& play) { return play.word == "TAMPER"; });
+		ASSERT_NE(tamper, plays.end()) << "TAMPER expected to be snatchable";
+		EXPECT_EQ(tamper->lexicons, Lexicon::All) << "TAMPER is in every word list";
+	}
+
+	query.lexicons = Lexicon::Popular | Lexicon::Collins;
+	std::vector<SnatchablePlay> plays = swg.generateSnatchablePlays(query);
+	EXPECT_TRUE(std::all_of(plays.begin(), plays.end(), [](const SnatchablePlay& play) { return (play.lexicons & Lexicon::Ospd) == 0; })) << "Only queried word lists are reported";
+}
+
+TEST_F(TestSnatchableWordGenerator, HouseRules) {
+	using SolveMode = SnatchableWordGenerator::SolveMode;
+	std::vector<std::string> words{ "P", "I", "T", "R" };
+	ASSERT_TRUE(swg.banHouseWord("tip"));
+	ASSERT_TRUE(swg.allowHouseWord("prit"));
+	for (SolveMode mode : { SolveMode::SubsetDriven, SolveMode::DictionaryDriven }) {
+		EXPECT_EQ(swg.generateSnatchableWords(words, mode), (std::vector<std::string>{ "PRIT", "TRIP", "PIT", "RIP" }));
+	}
+	EXPECT_EQ(swg.generateFormableWords("PITR"), (std::vector<std::string>{ "PRIT", "TRIP", "PIT", "RIP" }));
+
+	swg.clearHouseRules();
+	EXPECT_EQ(swg.generateSnatchableWords(words), (std::vector<std::string>{ "TRIP", "PIT", "RIP", "TIP" }));
+}
+
+TEST_F(TestSnatchableWordGenerator, UncertainTiles) {
+	std::vector<UncertainWord> words{ { { { 'P', 1.0 } } }, { { { 'I', 1.0 } } }, { { { 'T', 0.6 }, { 'F', 0.4 } } }, { { { 'R', 1.0 } } } };
+	std::vector<ProbableSnatchablePlay> plays = swg.generateProbableSnatchablePlays(words);
+	std::vector<std::string> playWords{};
+	std::for_each(plays.begin(), plays.end(), [&playWords](const ProbableSnatchablePlay& play) { playWords.push_back(play.word); });
+	EXPECT_EQ(playWords, (std::vector<std::string>{ "RIP", "TRIP", "PIT", "TIP", "FIR" })) << "RIP does not need the ambiguous tile";
+	EXPECT_DOUBLE_EQ(plays[0].probability, 1.0);
+	EXPECT_DOUBLE_EQ(plays[1].probability, 0.6);
+	EXPECT_DOUBLE_EQ(plays[4].probability, 0.4);
+
+	std::vector<ProbableSnatchablePlay> likely = swg.generateProbableSnatchablePlays(words, Lexicon::Popular, 0.7);
+	ASSERT_EQ(std::size(likely), 1) << "Only RIP is likely enough";
+	EXPECT_EQ(likely[0].word, "RIP");
+}
+
+TEST_F(TestSnatchableWordGenerator, FrameArena) {
+	SnatchQuery query{ { "PET", "RAM", "E", "P", "I", "T", "R" } };
+	std::byte buffer[256 * 1024];
+	for (SnatchableWordGenerator::SolveMode mode : { SnatchableWordGenerator::SolveMode::SubsetDriven, SnatchableWordGenerator::SolveMode::DictionaryDriven }) {
+		// The search must fit in the arena without falling back to the heap
+		std::pmr::monotonic_buffer_resource arena{ buffer, sizeof(buffer), std::pmr::null_memory_resource() };
+		EXPECT_EQ(swg.generateSnatchableWords(query, mode, &arena), swg.generateSnatchableWords(query, mode));
+	}
+}
+
+TEST_F(TestSnatchableWordGenerator, FrameArenaSteadyState) {
+	// PET and RAM laid out as rows of touching tiles, and the pool tiles E, P, I, T, R well apart
+	std::vector<LetterNode> letterNodes{};
+	auto addTiles = [&letterNodes](const std::string& letters, float pitch, float y) {
+		for (std::size_t i = 0; i < std::size(letters); ++i) {
+			letterNodes.push_back(LetterNode(letters[i], cv::RotatedRect(cv::Point2f(pitch * (i + 1), y), cv::Size2f(40, 40), 0.0)));
+		}
+	};
+	addTiles("PET", 40, 100);
+	addTiles("RAM", 40, 200);
+	addTiles("EPITR", 100, 300);
+	const std::vector<std::string> expected{ swg.generateSnatchableWords(std::vector<std::string>{ "PET", "RAM", "E", "P", "I", "T", "R" }) };
+	ASSERT_FALSE(expected.empty());
+
+	// Every frame must fit in the arena, as there is no heap to fall back to
+	FrameArena frameArena{ 256 * 1024, std::pmr::null_memory_resource() };
+	for (SnatchableWordGenerator::SolveMode mode : { SnatchableWordGenerator::SolveMode::SubsetDriven, SnatchableWordGenerator::SolveMode::DictionaryDriven }) {
+		for (int frame = 0; frame < 3; ++frame) {
+			std::pmr::memory_resource* resource{ frameArena.resource() };
+			const float cellSize{ LetterNodeUtils::pitchAdjacencyCellSize(letterNodes) };
+			std::pmr::vector<std::pmr::string> words{ LetterNodeUtils::findConnectedComponents(
+				LetterNodeUtils::createLetterNodeGraph(letterNodes, LetterNodeUtils::pitchAdjacencyStrategy, cellSize, resource), resource) };
+			ASSERT_EQ(std::size(words), 7);
+			std::pmr::vector<std::pmr::string> snatchable{ swg.generateSnatchableWords(words, SnatchQuery{}, mode, resource) };
+			EXPECT_EQ(std::vector<std::string>(snatchable.begin(), snatchable.end()), expected);
+			frameArena.reset();
+		}
+	}
+	EXPECT_EQ(frameArena.getGrowCount(), 0);
+}
+
+TEST_F(TestSnatchableWordGenerator, FrameArenaBoundedOnLargeBoard) {
+	// A board too large for SubsetDriven, whose memo is cleared for each of thousands of classes
+	const std::pmr::vector<std::pmr::string> words{ "STONE", "PLANET", "GARDEN", "RIVER", "CAT", "DOG", "HOUSE", "TRAIN", "LIGHT", "MOUSE",
+		"BREAD", "CHAIR", "FLOWER", "WATER", "MUSIC", "E", "A", "I", "O", "U", "R", "S", "T", "L", "N", "D", "G", "M", "P", "B" };
+	for (auto [lexicons, maxCapacity] : { std::pair<LexiconMask, std::size_t>{ Lexicon::Popular, 4 << 20 }, std::pair<LexiconMask, std::size_t>{ Lexicon::Collins, 16 << 20 } }) {
+		SnatchQuery query{};
+		query.lexicons = lexicons;
+		FrameArena frameArena{};
+		for (int frame = 0; frame < 2; ++frame) {
+			{
+				std::pmr::vector<std::pmr::string> snatchable{ swg.generateSnatchableWords(words, query, SnatchableWordGenerator::SolveMode::Automatic, frameArena.resource()) };
+				EXPECT_FALSE(snatchable.empty());
+			}
+			frameArena.reset();
+		}
+		EXPECT_LT(frameArena.capacity(), maxCapacity) << "The memo of each class is reused, not left in the arena";
+	}
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <future>
+#include <latch>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "startup_timeline.h"
+
+TEST(StartupTimelineTest, RecordsReturnValueAndTimes) {
+    StartupTimeline timeline{};
+    int value{ timeline.record("first", []() { return 42; }) };
+    timeline.record("second", []() { std::this_thread::sleep_for(std::chrono::milliseconds(5)); });
+    EXPECT_EQ(value, 42);
+
+    std::vector<StartupTimeline::Entry> entries{ timeline.getEntries() };
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_EQ(entries[0].component, "first");
+    EXPECT_EQ(entries[1].component, "second");
+    EXPECT_LE(entries[0].start, entries[0].end);
+    EXPECT_LE(entries[0].end, entries[1].start);
+    EXPECT_GE(entries[1].end - entries[1].start, 5.0);
+}
+
+TEST(StartupTimelineTest, RecordsComponentsWhichThrow) {
+    StartupTimeline timeline{};
+    EXPECT_THROW(timeline.record("broken", []() -> int { throw std::runtime_error("Cannot open camera."); }), std::runtime_error);
+    std::vector<StartupTimeline::Entry> entries{ timeline.getEntries() };
+    ASSERT_EQ(entries.size(), 1);
+    EXPECT_EQ(entries[0].component, "broken");
+}
+
+TEST(StartupTimelineTest, ConcurrentComponentsOverlap) {
+    StartupTimeline timeline{};
+    std::latch bothStarted{ 2 }; // neither component finishes before the other has started
+    auto waiting = [&timeline, &bothStarted](const std::string& component) {
+        return std::async(std::launch::async, [&timeline, &bothStarted, component]() {
+            timeline.record(component, [&bothStarted]() { bothStarted.arrive_and_wait(); });
+        });
+    };
+    std::future<void> a{ waiting("a") }, b{ waiting("b") };
+    a.get();
+    b.get();
+
+    std::vector<StartupTimeline::Entry> entries{ timeline.getEntries() };
+    ASSERT_EQ(entries.size(), 2);
+    EXPECT_LT(entries[0].start, entries[1].end);
+    EXPECT_LT(entries[1].start, entries[0].end);
+
+    std::ostringstream os;
+    timeline.print(os, 10);
+    const std::string printed{ os.str() };
+    EXPECT_NE(printed.find("a "), std::string::npos);
+    std::istringstream lines(printed);
+    std::string line;
+    int numLines{ 0 };
+    while (std::getline(lines, line)) {
+        ++numLines;
+        const std::size_t bar{ line.find('|') };
+        ASSERT_NE(bar, std::string::npos);
+        EXPECT_EQ(std::size(line) - bar, 12); // 10 columns between the bars
+        EXPECT_NE(line.find('#', bar), std::string::npos);
+    }
+    EXPECT_EQ(numLines, 2);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "text_detector.h"
+
+namespace {
+    void drawTile(cv::Mat& frame, const cv::RotatedRect& tile, const cv::Scalar& colour) {
+        cv::Point2f corners[4];
+        tile.points(corners);
+        std::vector<cv::Point> polygon{};
+        for (const cv::Point2f& corner : corners) polygon.push_back(cv::Point(cvRound(corner.x), cvRound(corner.y)));
+        cv::fillConvexPoly(frame, polygon, colour);
+    }
+
+    void sortByCentre(std::vector<cv::RotatedRect>& rotatedRectangles) {
+        std::sort(rotatedRectangles.begin(), rotatedRectangles.end(), [](const cv::RotatedRect& a, const cv::RotatedRect& b) {
+            return std::make_pair(a.center.x, a.center.y) < std::make_pair(b.center.x, b.center.y);
+        });
+    }
+}
+
+TEST(TextDetectorTest, ChangedRegionCoversWholeWords) {
+    TilePitchEstimator tilePitchEstimator{};
+    std::unique_ptr<TextDetector> textDetector{ TextDetector::createInstance(tilePitchEstimator) };
+    textDetector->setDetectionMode(TextDetector::DetectionMode::BackgroundModel);
+    const cv::Mat table(480, 640, CV_8UC1, cv::Scalar(60));
+    textDetector->updateBackground(table);
+
+    // Two tiles of a word at 30 degrees, whose bounding boxes overlap
+    const cv::Point2f axis(std::cos(static_cast<float>(CV_PI) / 6), std::sin(static_cast<float>(CV_PI) / 6));
+    const cv::Point2f first(250, 240);
+    const cv::Point2f second{ first + axis * 68.0f };
+    cv::Mat frame{ table.clone() };
+    drawTile(frame, cv::RotatedRect(first, cv::Size2f(60, 60), 30.0f), cv::Scalar(230));
+    drawTile(frame, cv::RotatedRect(second, cv::Size2f(60, 60), 30.0f), cv::Scalar(230));
+    std::vector<cv::RotatedRect> before{ textDetector->getTileLocations(frame, false) };
+    ASSERT_EQ(std::size(before), 2);
+
+    // Only the far end of the second tile changes, so the changed region only reaches
+    // the first tile once it has grown to cover the second
+    const cv::Point2f mark{ second + axis * 20.0f };
+    cv::rectangle(frame, cv::Rect(static_cast<int>(mark.x) - 3, static_cast<int>(mark.y) - 3, 6, 6), cv::Scalar(20), cv::FILLED);
+    std::vector<cv::RotatedRect> after{ textDetector->getTileLocations(frame, false) };
+    ASSERT_EQ(std::size(after), 2) << "Both tiles are still reported";
+
+    sortByCentre(before);
+    sortByCentre(after);
+    for (std::size_t i = 0; i < std::size(before); ++i) {
+        EXPECT_NEAR(after[i].center.x, before[i].center.x, 0.5);
+        EXPECT_NEAR(after[i].center.y, before[i].center.y, 0.5);
+        EXPECT_NEAR(after[i].size.area(), before[i].size.area(), 0.02 * before[i].size.area()) << "Tiles keep their original size";
+    }
+}
+
+TEST(TextDetectorTest, ContoursInStripsMatchWholeImage) {
+    // A 2 MP image split into 8 strips, with regions across every seam
+    const int numStrips{ 8 };
+    cv::Mat binary(1080, 1920, CV_8UC1, cv::Scalar(0));
+    const cv::Scalar white(255);
+    for (int k = 1; k < numStrips; ++k) {
+        const int seam{ binary.rows * k / numStrips };
+        const int x{ 40 + 20 * k };
+        cv::rectangle(binary, cv::Rect(x, seam - 20, 40, 40), white, cv::FILLED);
+        drawTile(binary, cv::RotatedRect(cv::Point2f(x + 120.0f, seam + 0.5f), cv::Size2f(40, 40), 45.0f), white);
+
+        // Squares touching diagonally across the seam, and squares one pixel apart
+        cv::rectangle(binary, cv::Rect(x + 200, seam - 20, 20, 20), white, cv::FILLED);
+        cv::rectangle(binary, cv::Rect(x + 220, seam, 20, 20), white, cv::FILLED);
+        cv::rectangle(binary, cv::Rect(x + 300, seam - 20, 20, 20), white, cv::FILLED);
+        cv::rectangle(binary, cv::Rect(x + 321, seam, 20, 20), white, cv::FILLED);
+
+        // A U whose legs cross the seam, with a separate region between its legs
+        cv::rectangle(binary, cv::Rect(x + 400, seam - 30, 10, 61), white, cv::FILLED);
+        cv::rectangle(binary, cv::Rect(x + 450, seam - 30, 10, 61), white, cv::FILLED);
+        cv::rectangle(binary, cv::Rect(x + 400, seam + 20, 60, 11), white, cv::FILLED);
+        cv::rectangle(binary, cv::Rect(x + 420, seam - 15, 20, 15), white, cv::FILLED);
+
+        // The same upside down
+        cv::rectangle(binary, cv::Rect(x + 500, seam - 30, 10, 61), white, cv::FILLED);
+        cv::rectangle(binary, cv::Rect(x + 550, seam - 30, 10, 61), white, cv::FILLED);
+        cv::rectangle(binary, cv::Rect(x + 500, seam - 30, 60, 11), white, cv::FILLED);
+        cv::rectangle(binary, cv::Rect(x + 520, seam, 20, 16), white, cv::FILLED);
+    }
+    cv::rectangle(binary, cv::Rect(1800, 100, 31, 601), white, cv::FILLED); // across several seams
+    cv::rectangle(binary, cv::Rect(1850, 134, 1, 2), white, cv::FILLED); // two pixels across a seam
+
+    std::vector<cv::RotatedRect> expected{}, actual{};
+    std::vector<std::vector<cv::Point>> contours;
+    cv::findContours(binary, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    for (const std::vector<cv::Point>& contour : contours) expected.push_back(cv::minAreaRect(contour));
+    for (const std::vector<cv::Point>& contour : TextDetector::findContoursInStrips(binary, numStrips)) actual.push_back(cv::minAreaRect(contour));
+    ASSERT_EQ(std::size(actual), std::size(expected));
+
+    sortByCentre(expected);
+    sortByCentre(actual);
+    for (std::size_t i = 0; i < std::size(expected); ++i) {
+        EXPECT_NEAR(actual[i].center.x, expected[i].center.x, 1e-3);
+        EXPECT_NEAR(actual[i].center.y, expected[i].center.y, 1e-3);
+        EXPECT_NEAR(actual[i].size.area(), expected[i].size.area(), 1e-2 * expected[i].size.area());
+    }
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "tile_pitch_estimator.h"
+
+class TilePitchEstimatorTest : public ::testing::Test {
+protected:
+    // A word of tiles with side 20 and a gap of 4, and a tile far away from it
+    std::vector<cv::RotatedRect> board() {
+        std::vector<cv::RotatedRect> tiles;
+        for (int i = 0; i < 5; ++i) {
+            tiles.push_back(cv::RotatedRect(cv::Point2f(24.0f * i, 50), cv::Size2f(20, 20), 10.0f));
+        }
+        tiles.push_back(cv::RotatedRect(cv::Point2f(300, 300), cv::Size2f(20, 20), 45.0f));
+        return tiles;
+    }
+};
+
+TEST_F(TilePitchEstimatorTest, NoEstimateWithoutSamples) {
+    TilePitchEstimator estimator;
+    EXPECT_FALSE(estimator.getTileSize());
+    EXPECT_TRUE(estimator.isPlausibleSize(cv::RotatedRect(cv::Point2f(0, 0), cv::Size2f(500, 500), 0.0f)));
+}
+
+TEST_F(TilePitchEstimatorTest, MedianSize) {
+    TilePitchEstimator estimator;
+    std::vector<cv::RotatedRect> tiles{ board() };
+    tiles.push_back(cv::RotatedRect(cv::Point2f(500, 100), cv::Size2f(90, 90), 0.0f)); // not a tile
+    for (int frame = 0; frame < 3; ++frame) {
+        estimator.update(tiles);
+    }
+    ASSERT_TRUE(estimator.getTileSize());
+    EXPECT_FLOAT_EQ(*estimator.getTileSize(), 20.0f);
+
+    EXPECT_TRUE(estimator.isPlausibleSize(cv::RotatedRect(cv::Point2f(0, 0), cv::Size2f(22, 21), 0.0f)));
+    EXPECT_TRUE(estimator.isPlausibleSize(cv::RotatedRect(cv::Point2f(0, 0), cv::Size2f(32, 32), 0.0f))) << "Tile near a tilted camera";
+    EXPECT_TRUE(estimator.isPlausibleSize(cv::RotatedRect(cv::Point2f(0, 0), cv::Size2f(12, 12), 0.0f))) << "Tile far from a tilted camera";
+    EXPECT_FALSE(estimator.isPlausibleSize(cv::RotatedRect(cv::Point2f(0, 0), cv::Size2f(90, 90), 0.0f)));
+    EXPECT_FALSE(estimator.isPlausibleSize(cv::RotatedRect(cv::Point2f(0, 0), cv::Size2f(5, 5), 0.0f)));
+    EXPECT_TRUE(estimator.isPlausibleSize(cv::RotatedRect(cv::Point2f(0, 0), cv::Size2f(10, 10), 0.0f), 2.0)) << "Half scale tile";
+
+    estimator.reset();
+    EXPECT_FALSE(estimator.getTileSize());
+}
+
+TEST_F(TilePitchEstimatorTest, ScaledTilesAndWindow) {
+    TilePitchEstimator estimator{ 12 };
+    std::vector<cv::RotatedRect> halfScale{ board() };
+    for (cv::RotatedRect& tile : halfScale) {
+        tile.center *= 0.5f;
+        tile.size.width *= 0.5f;
+        tile.size.height *= 0.5f;
+    }
+    estimator.update(halfScale, 2.0);
+    estimator.update(halfScale, 2.0);
+    ASSERT_TRUE(estimator.getTileSize());
+    EXPECT_FLOAT_EQ(*estimator.getTileSize(), 20.0f) << "Estimates are in full resolution pixels";
+
+    // The window only keeps the most recent samples, so the estimate follows the camera
+    std::vector<cv::RotatedRect> closer{ board() };
+    for (cv::RotatedRect& tile : closer) {
+        tile.center *= 2.0f;
+        tile.size.width *= 2.0f;
+        tile.size.height *= 2.0f;
+    }
+    estimator.update(closer);
+    estimator.update(closer);
+    EXPECT_FLOAT_EQ(*estimator.getTileSize(), 40.0f);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+#include "video_recorder.h"
+
+TEST(VideoRecorderTest, WritesEveryFrameInOrder) {
+    std::vector<int> written{};
+    VideoRecorder recorder{ [&written](const cv::Mat& frame) { written.push_back(frame.at<cv::Vec3b>(0, 0)[0]); }, cv::Size(8, 8), true, 16 };
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_TRUE(recorder.record(cv::Mat(8, 8, CV_8UC3, cv::Scalar::all(i))));
+    }
+    recorder.close();
+    EXPECT_EQ(written, (std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+    EXPECT_EQ(recorder.getWrittenCount(), 10);
+    EXPECT_EQ(recorder.getDroppedCount(), 0);
+}
+
+TEST(VideoRecorderTest, DropsFramesWhenEncoderIsBusy) {
+    std::atomic<bool> writing{ false };
+    std::promise<void> release;
+    std::shared_future<void> released{ release.get_future().share() };
+    VideoRecorder recorder{ [&](const cv::Mat&) { writing = true; released.wait(); }, cv::Size(8, 8), true, 2 };
+    cv::Mat frame(8, 8, CV_8UC3, cv::Scalar::all(0));
+
+    EXPECT_TRUE(recorder.record(frame));
+    while (!writing) std::this_thread::yield(); // the encoder is stuck on the first frame
+    EXPECT_TRUE(recorder.record(frame));
+    EXPECT_TRUE(recorder.record(frame));
+    EXPECT_FALSE(recorder.record(frame)) << "The queue is full, so the frame is dropped instead of waiting";
+    EXPECT_EQ(recorder.getDroppedCount(), 1);
+
+    release.set_value();
+    recorder.close();
+    EXPECT_EQ(recorder.getWrittenCount(), 3);
+    EXPECT_FALSE(recorder.record(frame)) << "Frames are dropped once closed";
+    EXPECT_EQ(recorder.getDroppedCount(), 2);
+}
+
+TEST(VideoRecorderTest, ConcurrentProducersDoNotOverfillQueue) {
+    std::atomic<bool> writing{ false };
+    std::promise<void> release;
+    std::shared_future<void> released{ release.get_future().share() };
+    VideoRecorder recorder{ [&](const cv::Mat&) { writing = true; released.wait(); }, cv::Size(8, 8), true, 4 };
+    cv::Mat frame(8, 8, CV_8UC3, cv::Scalar::all(0));
+    EXPECT_TRUE(recorder.record(frame));
+    while (!writing) std::this_thread::yield(); // the encoder is stuck on the first frame
+
+    std::atomic<std::size_t> accepted{ 0 };
+    std::vector<std::thread> producers{};
+    for (int i = 0; i < 8; ++i) {
+        producers.emplace_back([&]() {
+            for (int j = 0; j < 100; ++j) {
+                if (recorder.record(frame)) ++accepted;
+            }
+        });
+    }
+    for (std::thread& producer : producers) producer.join();
+    EXPECT_EQ(accepted, 4) << "Only the queue's capacity is accepted while the encoder is stuck";
+    EXPECT_EQ(recorder.getDroppedCount(), 8 * 100 - 4);
+
+    release.set_value();
+    recorder.close();
+    EXPECT_EQ(recorder.getWrittenCount(), 5);
+}
+
+TEST(VideoRecorderTest, ConvertsFramesToVideoFormat) {
+    std::vector<cv::Mat> written{};
+    VideoRecorder recorder{ [&written](const cv::Mat& frame) { written.push_back(frame.clone()); }, cv::Size(16, 8), true };
+    recorder.record(cv::Mat(4, 8, CV_8UC1, cv::Scalar(200)));
+    recorder.close();
+    ASSERT_EQ(std::size(written), 1);
+    EXPECT_EQ(written[0].size(), cv::Size(16, 8));
+    EXPECT_EQ(written[0].type(), CV_8UC3);
+    EXPECT_EQ(written[0].at<cv::Vec3b>(3, 7), cv::Vec3b(200, 200, 200));
+
+    EXPECT_THROW(VideoRecorder([](const cv::Mat&) {}, cv::Size(16, 8), true, 0), std::invalid_argument);
+}